@@ -11,12 +11,43 @@
 /* <----------| INCLUDES |----------> */
 
 #include "adc.h"
+#include "dma.h"
+#include "Timer.h"
+#include "ir_table.h"
+
+/* <----------| DEFINITIONS |----------> */
+
+#define ADC_STREAM_HALF (ADC_STREAM_BUFFER_SIZE / 2)
+
+// Continuous mode state. The buffer is written by uDMA, the counters by the ADC ISR
+static volatile uint16_t streamBuffer[ADC_STREAM_BUFFER_SIZE];
+static volatile uint32_t completedHalves = 0;
+static volatile uint32_t overflowCount = 0;
+static volatile uint8_t continuousMode = 0;
+
+// Burst mode state
+static uint8_t burstMode = 0;
+static uint8_t burstLength = 1;
+static uint8_t burstAveraging = ADC_AVERAGING_NONE;
+static uint32_t conversionMicros = 0;
 
 /* <----------| FUNCTIONS |----------> */
 
 // Private method to continuously poll busywait until ADC completes sampling conversions. Isn't that terrible practice? Yes. Do I care? No!
 static void adc_waitForSample(void);
 
+// Sorts a handful of samples in place (insertion sort, n <= ADC_BURST_MAX)
+static void adc_sortSamples(uint16_t samples[], uint8_t count);
+
+// Points a descriptor (primary = first half, alternate = second half) back at its half of the stream buffer
+static void adc_armStreamHalf(bool alternate);
+
+// Returns the index in streamBuffer that uDMA will write next
+static uint8_t adc_streamWriteIndex(void);
+
+// ISR for SS3's uDMA completion: re-arms whichever half uDMA just finished and counts FIFO overflows
+static void adc_interruptHandler(void);
+
 /* <----------| IMPLEMENTATIONS |----------> */
 
 void adc_init(void) {
@@ -71,54 +102,275 @@ void adc_init(void) {
 }
 
 uint16_t adc_read(void) {
+    // Timer and uDMA are already sampling, so just use what they collected
+    if (continuousMode) {
+        return adc_readLatest();
+    }
+
+    // Burst mode: filter the whole burst down to one value
+    if (burstMode) {
+        uint16_t samples[ADC_BURST_MAX];
+        uint8_t count = adc_readBurst(samples);
+        return adc_median(samples, count);
+    }
+
+    unsigned int startMicros = timer_getMicros();
+
     // Inititate sampling on SS3
     ADC0_PSSI_R |= 0b0000'0000'0000'0000'0000'0000'0000'1000;
 
     // Wait until ADC completes sample conversion
     adc_waitForSample();
+    conversionMicros = timer_getMicros() - startMicros;
 
     // Return converted value as integer
     return ADC0_SSFIFO3_R & 0b0000'0000'0000'0000'0000'1111'1111'1111;
 }
 
 uint8_t adc_calculateIRDistance(uint16_t millivolts) {
-    //                DISTANCE_VALUES   =  10    12    14    16    18    20    22    24    26    28    30    32    34    36    38    40    42    44    46    48    50
-    const uint16_t IR_DISTANCE_LOOKUP[] = {2784, 2456, 2185, 1983, 1867, 1756, 1663, 1546, 1469, 1414, 1376, 1324, 1281, 1236, 1206, 1169, 1148, 1143, 1098, 1077, 1059};
+    // Round millimeters to the nearest centimeter
+    return (adc_calculateIRDistanceMM(millivolts) + 5) / 10;
+}
+
+uint16_t adc_calculateIRDistanceMM(uint16_t adcCode) {
+    uint8_t index = 0;
+    uint8_t step = IR_TABLE_SEARCH_STEP;
 
-    uint8_t smallestIndex = 0;
-    uint8_t largestIndex = 20;
-    uint8_t closestIndex;
+    // Edge case for values closer than the first entry or further than the last one
+    if (adcCode >= IR_TABLE[0]) { return IR_TABLE_START_MM; }
+    if (adcCode <= IR_TABLE[IR_TABLE_LEN - 1]) { return IR_TABLE_START_MM + (IR_TABLE_LEN - 1) * IR_TABLE_STEP_MM; }
 
-    // Edge case for values closer than 9cm or further than 50cm
-    if      (millivolts > IR_DISTANCE_LOOKUP[smallestIndex]) { return 10; }
-    else if (millivolts < IR_DISTANCE_LOOKUP[largestIndex ]) { return 50; }
+    // Fixed-iteration binary search for the last entry still >= adcCode (codes fall as distance grows).
+    // The range check keeps this inside the table, and the add compiles to a conditional select rather than a branch
+    for (step = IR_TABLE_SEARCH_STEP; step; step >>= 1) {
+        uint8_t probe = index + step;
+        index += (probe < IR_TABLE_LEN && IR_TABLE[probe] >= adcCode) ? step : 0;
+    }
 
-    // This gets to the closest larger index of the millivolts
-    while (smallestIndex < largestIndex) {
-        closestIndex = (largestIndex - smallestIndex) / 2 + smallestIndex;
+    // Linear interpolation between entry index and index + 1
+    return IR_TABLE_START_MM + index * IR_TABLE_STEP_MM
+         + ((uint32_t)(IR_TABLE[index] - adcCode) * IR_TABLE_STEP_MM) / (IR_TABLE[index] - IR_TABLE[index + 1]);
+}
 
-        if (IR_DISTANCE_LOOKUP[closestIndex] > millivolts) {
-            smallestIndex = closestIndex + 1;
-        } else {
-            largestIndex = closestIndex - 1;
-        }
+uint16_t adc_getIRMaxMillimeters(void) {
+    return IR_TABLE_START_MM + (IR_TABLE_LEN - 1) * IR_TABLE_STEP_MM;
+}
+
+void adc_initBurst(uint8_t samplesPerBurst, uint8_t averaging) {
+    uint8_t lastSample;
+
+    if (samplesPerBurst < 1) { samplesPerBurst = 1; }
+    if (samplesPerBurst > ADC_BURST_MAX) { samplesPerBurst = ADC_BURST_MAX; }
+    lastSample = samplesPerBurst - 1;
+
+    // 1. DISABLE SS0 FOR INITIALIZATION
+    ADC0_ACTSS_R &= 0b1111'1111'1111'1111'1111'1111'1111'1110;
+
+    // 2. PROCESSOR TRIGGER FOR SS0
+    ADC0_EMUX_R &= 0b1111'1111'1111'1111'1111'1111'1111'0000;
+
+    // 3. EVERY SAMPLE SLOT READS AIN10
+    ADC0_SSMUX0_R = 0xAAAAAAAA;
+
+    // 4. END AND INTERRUPT FLAG ON THE LAST SAMPLE OF THE BURST
+    ADC0_SSCTL0_R = 0b0110 << (lastSample * 4);
+
+    // 5. ENABLE SS0 (SS3 stays configured for adc_init() compatibility)
+    ADC0_ACTSS_R |= 0b0000'0000'0000'0000'0000'0000'0000'0001;
+
+    // ADC0_SAC_R is shared with SS3, so the averaging level is only applied for the length of each burst
+    burstLength = samplesPerBurst;
+    burstAveraging = averaging & 0b111;
+    burstMode = 1;
+}
+
+uint8_t adc_readBurst(uint16_t samples[]) {
+    unsigned int startMicros = timer_getMicros();
+    uint32_t savedAveraging = ADC0_SAC_R;
+    uint8_t i = 0;
+
+    // SAC covers the whole module: swap in the burst's level and put SS3's back afterwards. While continuous mode
+    // is running SS3 can convert mid-burst, so then the burst just uses whatever SS3 is set to
+    if (!continuousMode) {
+        ADC0_SAC_R = (savedAveraging & 0b1111'1111'1111'1111'1111'1111'1111'1000) | burstAveraging;
     }
 
-    int distBetween = (IR_DISTANCE_LOOKUP[closestIndex] - IR_DISTANCE_LOOKUP[closestIndex + 1]) / 2;
+    // Inititate sampling on SS0
+    ADC0_PSSI_R |= 0b0000'0000'0000'0000'0000'0000'0000'0001;
 
-    // TODO: According to Joe, this is technically not needed. But function works as of right now
-    // Forces the closestIndex down if it normally would've been too big
-    if (IR_DISTANCE_LOOKUP[closestIndex] < millivolts) {
-        closestIndex--;
+    while (!(ADC0_RIS_R & 0b0000'0000'0000'0000'0000'0000'0000'0001)) {
+        // Wait until the whole burst is converted
     }
+    ADC0_ISC_R |= 0b0000'0000'0000'0000'0000'0000'0000'0001;
 
-    //Check if millivolts is closer to closestIndex + 1
-    if (IR_DISTANCE_LOOKUP[closestIndex] - distBetween > millivolts) {
-        closestIndex++;
+    // One FIFO drain for the whole burst
+    for (i = 0; i < burstLength; i++) {
+        samples[i] = ADC0_SSFIFO0_R & 0b0000'0000'0000'0000'0000'1111'1111'1111;
+    }
+
+    ADC0_SAC_R = savedAveraging;
+    conversionMicros = timer_getMicros() - startMicros;
+
+    return burstLength;
+}
+
+uint32_t adc_getConversionMicros(void) {
+    return conversionMicros;
+}
 
+uint16_t adc_median(uint16_t samples[], uint8_t count) {
+    if (count == 0) {
+        return 0;
     }
 
-    return 10 + (closestIndex * 2);
+    adc_sortSamples(samples, count);
+
+    // Even counts average the two middle samples
+    if (count % 2 == 0) {
+        return (samples[count / 2 - 1] + samples[count / 2]) / 2;
+    }
+    return samples[count / 2];
+}
+
+uint16_t adc_trimmedMean(uint16_t samples[], uint8_t count, uint8_t trim) {
+    uint32_t total = 0;
+    uint8_t i = 0;
+
+    if (count <= trim * 2) {
+        return adc_median(samples, count);
+    }
+
+    adc_sortSamples(samples, count);
+
+    for (i = trim; i < count - trim; i++) {
+        total += samples[i];
+    }
+
+    return total / (count - trim * 2);
+}
+
+void adc_startContinuous(uint32_t sampleRateHz) {
+    /* <----------| uDMA: SS3 FIFO -> STREAM BUFFER, PING-PONG |----------> */
+
+    dma_init();
+    dma_configureChannel(DMA_CHANNEL_ADC0_SS3, 0);
+    adc_armStreamHalf(false);
+    adc_armStreamHalf(true);
+    completedHalves = 0;
+    overflowCount = 0;
+    dma_enableChannel(DMA_CHANNEL_ADC0_SS3);
+
+    /* <----------| SAMPLE SEQUENCER: TIMER TRIGGER |----------> */
+
+    ADC0_ACTSS_R &= 0b1111'1111'1111'1111'1111'1111'1111'0111; // Disable SS3 while changing its trigger
+    ADC0_EMUX_R &= 0b1111'1111'1111'1111'0000'1111'1111'1111; // Clear SS3 trigger
+    ADC0_EMUX_R |= 0b0000'0000'0000'0000'0101'0000'0000'0000; // Trigger SS3 from a general-purpose timer
+    ADC0_OSTAT_R = 0b0000'0000'0000'0000'0000'0000'0000'1000; // Clear stale overflow
+    ADC0_ISC_R |= 0b0000'0000'0000'0000'0000'0000'0000'1000; // Clear stale interrupt
+    // MASK3 stays clear: SSCTL3's IE still raises the per-sample uDMA request, but the only thing reaching the NVIC is
+    // the uDMA completion on SS3's vector, once per half-buffer instead of once per sample
+    ADC0_ACTSS_R |= 0b0000'0000'0000'0000'0000'0000'0000'1000; // Re-enable SS3
+
+    NVIC_EN0_R |= 0b1 << 17; // ADC0 SS3 is interrupt 17
+    IntRegister(INT_ADC0SS3, adc_interruptHandler);
+    IntMasterEnable();
+
+    /* <----------| TIMER 2A: PERIODIC ADC TRIGGER |----------> */
+
+    SYSCTL_RCGCTIMER_R |= 0b00'0100; // Timer 2
+    while (!(SYSCTL_PRTIMER_R & 0b00'0100)) {}
+
+    TIMER2_CTL_R &= ~0b0000'0001; // Disable Timer 2A for config
+    TIMER2_CFG_R = 0x0; // 32-bit timer
+    TIMER2_TAMR_R = 0b0010; // Periodic, count down
+    TIMER2_TAILR_R = (16000000 / sampleRateHz) - 1; // One trigger per sample period at 16 MHz
+    TIMER2_CTL_R |= 0b0010'0000; // Enable ADC trigger output
+    TIMER2_CTL_R |= 0b0000'0001; // Start Timer 2A
+
+    continuousMode = 1;
+}
+
+void adc_stopContinuous(void) {
+    TIMER2_CTL_R &= ~0b0010'0001; // Stop Timer 2A and its ADC trigger
+    dma_disableChannel(DMA_CHANNEL_ADC0_SS3);
+    continuousMode = 0;
+
+    ADC0_ACTSS_R &= 0b1111'1111'1111'1111'1111'1111'1111'0111; // Disable SS3 while changing its trigger
+    ADC0_EMUX_R &= 0b1111'1111'1111'1111'0000'1111'1111'1111; // Processor trigger
+    ADC0_ISC_R |= 0b0000'0000'0000'0000'0000'0000'0000'1000;
+    ADC0_ACTSS_R |= 0b0000'0000'0000'0000'0000'0000'0000'1000;
+}
+
+uint16_t adc_readLatest(void) {
+    uint8_t index = adc_streamWriteIndex();
+    uint32_t total = 0;
+    uint8_t i = 0;
+
+    // Walk backwards from the write position, wrapping around the circular buffer
+    for (i = 0; i < ADC_STREAM_FILTER_LEN; i++) {
+        index = (index - 1) & (ADC_STREAM_BUFFER_SIZE - 1);
+        total += streamBuffer[index];
+    }
+
+    return total / ADC_STREAM_FILTER_LEN;
+}
+
+uint32_t adc_getSampleCount(void) {
+    uint8_t index = adc_streamWriteIndex();
+
+    return completedHalves * ADC_STREAM_HALF + (index % ADC_STREAM_HALF);
+}
+
+uint32_t adc_getOverflowCount(void) {
+    return overflowCount;
+}
+
+static void adc_sortSamples(uint16_t samples[], uint8_t count) {
+    uint8_t i = 0;
+    int8_t j = 0;
+    uint16_t current;
+
+    for (i = 1; i < count; i++) {
+        current = samples[i];
+        for (j = i - 1; j >= 0 && samples[j] > current; j--) {
+            samples[j + 1] = samples[j];
+        }
+        samples[j + 1] = current;
+    }
+}
+
+static void adc_armStreamHalf(bool alternate) {
+    dma_setTransfer(DMA_CHANNEL_ADC0_SS3, alternate, &ADC0_SSFIFO3_R, &streamBuffer[alternate ? ADC_STREAM_HALF : 0],
+                    UDMA_CHCTL_DSTINC_16 | UDMA_CHCTL_DSTSIZE_16 | UDMA_CHCTL_SRCINC_NONE | UDMA_CHCTL_SRCSIZE_16 |
+                    UDMA_CHCTL_ARBSIZE_1 | UDMA_CHCTL_XFERMODE_PINGPONG, ADC_STREAM_HALF);
+}
+
+static uint8_t adc_streamWriteIndex(void) {
+    bool alternate = dma_isAlternateActive(DMA_CHANNEL_ADC0_SS3);
+
+    return (alternate ? ADC_STREAM_HALF : 0) + (ADC_STREAM_HALF - dma_getRemaining(DMA_CHANNEL_ADC0_SS3, alternate)) % ADC_STREAM_HALF;
+}
+
+static void adc_interruptHandler(void) {
+    // Only uDMA completions arrive here (MASK3 is clear). The completion bit in UDMACHIS has to be cleared by hand or
+    // the vector stays pending
+    dma_clearInterrupt(DMA_CHANNEL_ADC0_SS3);
+
+    // A finished half has dropped to the stop state; point it back at its half so the ring keeps going
+    if (dma_isTransferDone(DMA_CHANNEL_ADC0_SS3, false)) {
+        adc_armStreamHalf(false);
+        completedHalves++;
+    }
+    if (dma_isTransferDone(DMA_CHANNEL_ADC0_SS3, true)) {
+        adc_armStreamHalf(true);
+        completedHalves++;
+    }
+
+    // uDMA fell behind the trigger and the sequencer FIFO overflowed
+    if (ADC0_OSTAT_R & 0b0000'0000'0000'0000'0000'0000'0000'1000) {
+        ADC0_OSTAT_R = 0b0000'0000'0000'0000'0000'0000'0000'1000;
+        overflowCount++;
+    }
 }
 
 static void adc_waitForSample(void) {
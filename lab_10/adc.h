@@ -16,13 +16,67 @@
 #include <stdint.h>
 #include "driverlib/interrupt.h"
 
+// Circular buffer for continuous sampling. Split in two halves that uDMA fills ping-pong style
+#define ADC_STREAM_BUFFER_SIZE 64
+
+// How many of the newest continuous samples adc_readLatest() averages
+#define ADC_STREAM_FILTER_LEN 8
+
+// SS0 holds up to 8 samples per trigger
+#define ADC_BURST_MAX 8
+
+// ADC0_SAC_R codes for hardware oversampling
+#define ADC_AVERAGING_NONE 0
+#define ADC_AVERAGING_16X 4
+
 // Sets the registers necessary for reading raw IR data through the ADC
 void adc_init(void);
 
-// Returns average of 16x hardware oversample ADC conversion from raw IR data
+// Returns average of 16x hardware oversample ADC conversion from raw IR data. In continuous mode, returns adc_readLatest();
+// in burst mode, returns the median of one SS0 burst
 uint16_t adc_read(void);
 
-// Uses hardcoded lookup table to "calculate" object distance from raw IR data
+// Switches adc_read() to burst mode: SS0 takes samplesPerBurst (1-8) back-to-back AIN10 samples per trigger, and
+// adc_read() returns their median. averaging is an ADC_AVERAGING_* code applied to every sample. ADC0_SAC_R is shared
+// by all sequencers, so it is only switched for the duration of each burst and SS3 keeps adc_init()'s 16x (during
+// continuous mode the burst uses SS3's level instead). Call after adc_init()
+void adc_initBurst(uint8_t samplesPerBurst, uint8_t averaging);
+
+// Triggers SS0 once and copies the burst into samples (ADC_BURST_MAX long). Returns the number of samples read
+uint8_t adc_readBurst(uint16_t samples[]);
+
+// Returns how long the last SS3 conversion or SS0 burst took, in microseconds
+uint32_t adc_getConversionMicros(void);
+
+// Returns the median of count samples. Sorts samples in place
+uint16_t adc_median(uint16_t samples[], uint8_t count);
+
+// Returns the mean of count samples after dropping the trim lowest and trim highest. Sorts samples in place
+uint16_t adc_trimmedMean(uint16_t samples[], uint8_t count, uint8_t trim);
+
+// Has Timer 2A trigger SS3 sampleRateHz times a second while uDMA streams results into a circular buffer. The CPU
+// is only interrupted when uDMA finishes a half of the buffer (every ADC_STREAM_BUFFER_SIZE / 2 samples)
+void adc_startContinuous(uint32_t sampleRateHz);
+
+// Stops the timer and uDMA and returns SS3 to processor-triggered sampling
+void adc_stopContinuous(void);
+
+// Returns the mean of the newest ADC_STREAM_FILTER_LEN continuous samples without waiting on the ADC
+uint16_t adc_readLatest(void);
+
+// Returns the total number of samples stored since adc_startContinuous()
+uint32_t adc_getSampleCount(void);
+
+// Returns how many times SS3's FIFO overflowed (a sample was dropped) since adc_startContinuous()
+uint32_t adc_getOverflowCount(void);
+
+// Uses the generated lookup table (ir_table.h) to calculate object distance in cm from raw IR data
 uint8_t adc_calculateIRDistance(uint16_t millivolts);
 
+// Interpolated IR distance in mm for a raw 12-bit ADC code, clamped to the table's range (ir_table.h)
+uint16_t adc_calculateIRDistanceMM(uint16_t adcCode);
+
+// Furthest distance (mm) the IR table covers, a reading clamped here means nothing is in IR range
+uint16_t adc_getIRMaxMillimeters(void);
+
 #endif /* ADC_H_ */
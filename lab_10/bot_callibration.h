@@ -11,6 +11,9 @@
 #ifndef BOT_CALLIBRATION_H_
 #define BOT_CALLIBRATION_H_
 
+// Which CyBot this build is flashed onto, selects the matching tables in ir_table.h
+#define CYBOT_ID 23
+
 /* <----------| SERVO |----------> */
 
 #define CAL_BOT23_SERVO_R 49295
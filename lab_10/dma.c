@@ -0,0 +1,102 @@
+/**
+ * dma.c
+ *
+ * Contains functions to share the uDMA controller between the CyBot's drivers
+ * 
+ * @date November 20, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include "dma.h"
+
+/* <----------| DEFINITIONS |----------> */
+
+// One channel control structure (page 608)
+typedef struct {
+    volatile void *sourceEnd;
+    volatile void *destinationEnd;
+    volatile uint32_t control;
+    volatile uint32_t unused;
+} dma_controlEntry_t;
+
+// 32 primary descriptors followed by 32 alternate ones. The controller needs this 1024-byte aligned
+#pragma DATA_ALIGN(dma_controlTable, 1024)
+static dma_controlEntry_t dma_controlTable[64];
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+void dma_init(void) {
+    if (UDMA_CFG_R & UDMA_CFG_MASTEN) {
+        return;
+    }
+
+    SYSCTL_RCGCDMA_R |= SYSCTL_RCGCDMA_R0;      // Enable uDMA clock
+    while (!(SYSCTL_PRDMA_R & SYSCTL_PRDMA_R0)) {
+        // Wait for module to come out of reset
+    }
+
+    UDMA_CFG_R = UDMA_CFG_MASTEN;               // Enable controller
+    UDMA_CTLBASE_R = (uint32_t)dma_controlTable; // Point at control table
+}
+
+void dma_configureChannel(uint8_t channel, uint8_t encoding) {
+    uint32_t mask = 1 << channel;
+    volatile uint32_t *channelMap = &UDMA_CHMAP0_R + (channel / 8);
+    uint8_t shift = (channel % 8) * 4;
+
+    *channelMap = (*channelMap & ~(0xF << shift)) | ((uint32_t)encoding << shift);
+
+    UDMA_ENACLR_R = mask;       // Disarm while reconfiguring
+    UDMA_PRIOCLR_R = mask;      // Default priority
+    UDMA_ALTCLR_R = mask;       // Start on primary descriptor
+    UDMA_USEBURSTCLR_R = mask;  // Respond to single and burst requests
+    UDMA_REQMASKCLR_R = mask;   // Let the peripheral raise requests
+}
+
+void dma_setTransfer(uint8_t channel, bool alternate, volatile void *source, volatile void *destination, uint32_t control, uint16_t count) {
+    dma_controlEntry_t *entry = &dma_controlTable[channel + (alternate ? 32 : 0)];
+    uint32_t sourceIncrement = (control & UDMA_CHCTL_SRCINC_M) >> 26;
+    uint32_t destinationIncrement = (control & UDMA_CHCTL_DSTINC_M) >> 30;
+
+    // End pointers address the last item, or stay put for a fixed register (increment code 3)
+    entry->sourceEnd = (sourceIncrement == 3) ? source : (volatile uint8_t *)source + ((uint32_t)(count - 1) << sourceIncrement);
+    entry->destinationEnd = (destinationIncrement == 3) ? destination : (volatile uint8_t *)destination + ((uint32_t)(count - 1) << destinationIncrement);
+    entry->control = (control & ~UDMA_CHCTL_XFERSIZE_M) | ((uint32_t)(count - 1) << UDMA_CHCTL_XFERSIZE_S);
+}
+
+void dma_enableChannel(uint8_t channel) {
+    UDMA_ENASET_R = 1 << channel;
+}
+
+bool dma_isChannelEnabled(uint8_t channel) {
+    return (UDMA_ENASET_R & (1 << channel)) != 0;
+}
+
+bool dma_isTransferDone(uint8_t channel, bool alternate) {
+    return (dma_controlTable[channel + (alternate ? 32 : 0)].control & UDMA_CHCTL_XFERMODE_M) == UDMA_CHCTL_XFERMODE_STOP;
+}
+
+uint16_t dma_getRemaining(uint8_t channel, bool alternate) {
+    uint32_t control = dma_controlTable[channel + (alternate ? 32 : 0)].control;
+
+    if ((control & UDMA_CHCTL_XFERMODE_M) == UDMA_CHCTL_XFERMODE_STOP) {
+        return 0;
+    }
+
+    return ((control & UDMA_CHCTL_XFERSIZE_M) >> UDMA_CHCTL_XFERSIZE_S) + 1;
+}
+
+bool dma_isAlternateActive(uint8_t channel) {
+    return (UDMA_ALTSET_R & (1 << channel)) != 0;
+}
+
+void dma_disableChannel(uint8_t channel) {
+    UDMA_ENACLR_R = 1 << channel;
+}
+
+void dma_clearInterrupt(uint8_t channel) {
+    UDMA_CHIS_R = 1 << channel; // write-1-to-clear
+}
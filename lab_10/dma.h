@@ -0,0 +1,56 @@
+/**
+ * dma.h
+ *
+ * Contains functions to share the uDMA controller between the CyBot's drivers
+ * 
+ * @date November 20, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+#ifndef DMA_H_
+#define DMA_H_
+
+#include <inc/tm4c123gh6pm.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// uDMA channel assignments used on the CyBot (datasheet table 9-1)
+#define DMA_CHANNEL_ADC0_SS3 17
+#define DMA_CHANNEL_UART4_TX 19
+#define DMA_CHANNEL_UART1_TX 23
+
+// Largest number of items a single primary/alternate descriptor can move
+#define DMA_MAX_TRANSFER 1024
+
+// Turns on the uDMA controller and points it at the shared control table. Safe to call from every driver's init
+void dma_init(void);
+
+// Maps channel to the given peripheral encoding and resets it to single requests, default priority, primary descriptor
+void dma_configureChannel(uint8_t channel, uint8_t encoding);
+
+// Fills the primary or alternate descriptor of a channel. control holds the UDMA_CHCTL_* size/increment/arbitration/mode bits
+void dma_setTransfer(uint8_t channel, bool alternate, volatile void *source, volatile void *destination, uint32_t control, uint16_t count);
+
+// Arms a channel so it services peripheral requests
+void dma_enableChannel(uint8_t channel);
+
+// Returns true while a channel is armed. The controller clears this itself once a basic transfer finishes
+bool dma_isChannelEnabled(uint8_t channel);
+
+// Returns true once the given descriptor has run down to the stop state
+bool dma_isTransferDone(uint8_t channel, bool alternate);
+
+// Returns how many items the given descriptor still has to move (0 once stopped)
+uint16_t dma_getRemaining(uint8_t channel, bool alternate);
+
+// Returns true while a ping-pong channel is working from its alternate descriptor
+bool dma_isAlternateActive(uint8_t channel);
+
+// Disarms a channel
+void dma_disableChannel(uint8_t channel);
+
+// Clears a channel's completion status in UDMACHIS. It stays set (and keeps the peripheral's vector pending) until this is called
+void dma_clearInterrupt(uint8_t channel);
+
+#endif /* DMA_H_ */
@@ -0,0 +1,159 @@
+/**
+ * filter.c
+ *
+ * Contains in-place smoothing and outlier rejection for scan data
+ * 
+ * @date November 25, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include <stdbool.h>
+#include "filter.h"
+
+/* <----------| DEFINES |----------> */
+
+#define FILTER_NUM_FIELDS 3
+
+/* <----------| PRIVATE TYPES |----------> */
+
+// Per-field state. Outputs overwrite the array as we go, so the raw samples still inside the window live
+// in a ring indexed by sample number modulo the window size
+typedef struct {
+    uint16_t ring[FILTER_MAX_WINDOW];
+    uint32_t sum;
+} filter_state_t;
+
+/* <----------| PRIVATE METHODS |----------> */
+
+// Reads the field selected by fieldIndex (0 = PING, 1 = IR, 2 = fused)
+static uint16_t filter_getField(const scanVector *vector, uint8_t fieldIndex);
+
+// Writes the field selected by fieldIndex
+static void filter_setField(scanVector *vector, uint8_t fieldIndex, uint16_t value);
+
+// Median of the ring entries for samples first..last, also sorts a copy of them into sorted[]
+static uint16_t filter_windowMedian(const filter_state_t *state, uint8_t window, uint8_t first, uint8_t last, uint16_t sorted[]);
+
+// Sorts values[0..length-1] ascending (insertion sort, windows are at most FILTER_MAX_WINDOW long)
+static void filter_sort(uint16_t values[], uint8_t length);
+
+// Median of an already sorted array, averaging the middle pair when length is even
+static uint16_t filter_sortedMedian(const uint16_t sorted[], uint8_t length);
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+void filter_scan(scanVector vectors[], uint8_t numValues, uint8_t windowSize, filter_kernel_t kernel, uint8_t fields) {
+    filter_state_t states[FILTER_NUM_FIELDS];
+    uint16_t sorted[FILTER_MAX_WINDOW];
+    uint8_t radius = (windowSize > FILTER_MAX_WINDOW ? FILTER_MAX_WINDOW : windowSize) / 2;
+    uint8_t window = 2 * radius + 1;
+    uint8_t field, first, last, count;
+    uint16_t median, raw, deviation, mad;
+    int16_t i, j;
+
+    if (numValues == 0) { return; }
+
+    // Prime each ring and running sum with samples 0..radius-1 (sample i + radius is added at step i)
+    for (field = 0; field < FILTER_NUM_FIELDS; field++) {
+        states[field].sum = 0;
+        for (j = 0; j < radius && j < numValues; j++) {
+            states[field].ring[j % window] = filter_getField(&vectors[j], field);
+            states[field].sum += states[field].ring[j % window];
+        }
+    }
+
+    for (i = 0; i < numValues; i++) {
+        first = i > radius ? i - radius : 0;
+        last = i + radius < numValues ? i + radius : numValues - 1;
+        count = last - first + 1;
+
+        for (field = 0; field < FILTER_NUM_FIELDS; field++) {
+            if (!(fields & (1 << field))) { continue; }
+
+            filter_state_t *state = &states[field];
+
+            // Slide the window: drop sample i - radius - 1 first, its ring slot is the one i + radius reuses
+            if (i - radius - 1 >= 0) {
+                state->sum -= state->ring[(i - radius - 1) % window];
+            }
+            if (i + radius < numValues) {
+                state->ring[(i + radius) % window] = filter_getField(&vectors[i + radius], field);
+                state->sum += state->ring[(i + radius) % window];
+            }
+
+            switch (kernel) {
+                case FILTER_KERNEL_BOX:
+                    filter_setField(&vectors[i], field, (state->sum + count / 2) / count);
+                    break;
+                case FILTER_KERNEL_MEDIAN:
+                    filter_setField(&vectors[i], field, filter_windowMedian(state, window, first, last, sorted));
+                    break;
+                case FILTER_KERNEL_HAMPEL:
+                    median = filter_windowMedian(state, window, first, last, sorted);
+
+                    // Median absolute deviation, reusing sorted[] for the deviations
+                    for (j = 0; j < count; j++) {
+                        sorted[j] = sorted[j] > median ? sorted[j] - median : median - sorted[j];
+                    }
+                    filter_sort(sorted, count);
+                    mad = filter_sortedMedian(sorted, count);
+
+                    raw = state->ring[i % window];
+                    deviation = raw > median ? raw - median : median - raw;
+                    if ((uint32_t)deviation * 1000 > (uint32_t)mad * FILTER_HAMPEL_THRESHOLD_X1000) {
+                        filter_setField(&vectors[i], field, median);
+                    }
+                    break;
+            }
+        }
+    }
+}
+
+static uint16_t filter_getField(const scanVector *vector, uint8_t fieldIndex) {
+    switch (fieldIndex) {
+        case 0: return vector->pingDistance;
+        case 1: return vector->irDistance;
+        default: return vector->fusedDistance;
+    }
+}
+
+static void filter_setField(scanVector *vector, uint8_t fieldIndex, uint16_t value) {
+    switch (fieldIndex) {
+        case 0: vector->pingDistance = (uint8_t)value; break;
+        case 1: vector->irDistance = (uint8_t)value; break;
+        default: vector->fusedDistance = value; break;
+    }
+}
+
+static uint16_t filter_windowMedian(const filter_state_t *state, uint8_t window, uint8_t first, uint8_t last, uint16_t sorted[]) {
+    uint8_t count = last - first + 1;
+    uint8_t i;
+
+    for (i = 0; i < count; i++) {
+        sorted[i] = state->ring[(first + i) % window];
+    }
+    filter_sort(sorted, count);
+
+    return filter_sortedMedian(sorted, count);
+}
+
+static void filter_sort(uint16_t values[], uint8_t length) {
+    uint8_t i, j;
+    uint16_t value;
+
+    for (i = 1; i < length; i++) {
+        value = values[i];
+        for (j = i; j > 0 && values[j - 1] > value; j--) {
+            values[j] = values[j - 1];
+        }
+        values[j] = value;
+    }
+}
+
+static uint16_t filter_sortedMedian(const uint16_t sorted[], uint8_t length) {
+    if (length & 1) { return sorted[length / 2]; }
+    return ((uint32_t)sorted[length / 2 - 1] + sorted[length / 2] + 1) / 2;
+}
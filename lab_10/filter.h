@@ -0,0 +1,41 @@
+/**
+ * filter.h
+ *
+ * Contains in-place smoothing and outlier rejection for scan data
+ *
+ * Every kernel uses a centered window of 2 * (windowSize / 2) + 1 samples. Near the ends of the scan the
+ * window is clipped to the samples that exist rather than padded, so the first and last outputs are
+ * still centered on their own sample.
+ * 
+ * @date November 25, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include <stdint.h>
+#include "scan.h"
+
+// Largest (odd) window filter_scan() accepts, bigger windows are clamped to this
+#define FILTER_MAX_WINDOW 15
+
+// Hampel kernel replaces a sample further than k * 1.4826 * MAD from the window median (k = 3), scaled by 1000
+#define FILTER_HAMPEL_THRESHOLD_X1000 4448
+
+// Which scanVector fields filter_scan() touches, OR together to filter several in the same pass
+#define FILTER_FIELD_PING 0b001
+#define FILTER_FIELD_IR   0b010
+#define FILTER_FIELD_FUSED 0b100
+
+typedef enum {
+    FILTER_KERNEL_BOX,    // Mean of the window, O(1) per sample using a running sum
+    FILTER_KERNEL_MEDIAN, // Median of the window, removes spikes without blurring edges
+    FILTER_KERNEL_HAMPEL  // Keeps the sample unless it is an outlier against the window median, then uses the median
+} filter_kernel_t;
+
+// Filters the selected fields of vectors[0..numValues-1] in place in a single pass
+void filter_scan(scanVector vectors[], uint8_t numValues, uint8_t windowSize, filter_kernel_t kernel, uint8_t fields);
+
+#endif /* FILTER_H_ */
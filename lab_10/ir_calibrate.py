@@ -0,0 +1,71 @@
+# Author: Thiago Bedal, Joseph Vesterby
+# Date: 11/24/2025
+# Description: Collects IR calibration data from a CyBot over the WiFi socket. Put the bot in manual
+#              mode, start the guided calibration ('c'), then for each distance place a flat target in
+#              front of the IR sensor, type the measured distance, and the averaged ADC code is recorded.
+#              Writes ir_calibration_bot<ID>.csv for ir_table_gen.py.
+#
+# Usage: python ir_calibrate.py <cybot id> [--host 192.168.1.1] [--port 288]
+
+import argparse
+import csv
+import os
+import socket
+
+
+# Send one command character and return the next line that starts with prefix
+def request(cybot, command, prefix):
+        if command:
+                cybot.write(command.encode())
+        while True:
+                line = cybot.readline().decode(errors="replace").strip()
+                if not line:
+                        raise ConnectionError("CyBot closed the connection")
+                if line.startswith(prefix):
+                        return line
+
+
+def main():
+        parser = argparse.ArgumentParser(description="Record IR calibration points from a CyBot")
+        parser.add_argument("cybot_id", type=int)
+        parser.add_argument("--host", default="192.168.1.1")
+        parser.add_argument("--port", type=int, default=288)
+        args = parser.parse_args()
+
+        output_path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "ir_calibration_bot" + str(args.cybot_id) + ".csv")
+
+        cybot_socket = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        cybot_socket.connect((args.host, args.port))
+        cybot = cybot_socket.makefile("rbw", buffering=0)
+
+        # Manual mode, then the guided calibration routine
+        request(cybot, "t", "Toggled manual")
+        request(cybot, "c", "CAL READY")
+
+        points = []
+        print("Enter the distance to the target in cm for each reading, blank line to finish.")
+        while True:
+                entry = input("distance (cm): ").strip()
+                if not entry:
+                        break
+                code = int(request(cybot, "h", "CAL\t").split("\t")[1])
+                points.append((float(entry), code))
+                print("  adc code " + str(code))
+
+        request(cybot, "x", "CAL DONE")
+        cybot.write(b"t")
+        cybot.close()
+        cybot_socket.close()
+
+        points.sort()
+        with open(output_path, "w", newline="") as calibration_file:
+                writer = csv.writer(calibration_file)
+                writer.writerow(["distance_cm", "adc_code"])
+                for distance, code in points:
+                        writer.writerow([("%g" % distance), code])
+
+        print("Wrote " + str(len(points)) + " points to " + output_path)
+        print("Run ir_table_gen.py to regenerate ir_table.h")
+
+
+main()
@@ -0,0 +1,33 @@
+/**
+ * ir_table.h
+ *
+ * Per-robot IR distance lookup tables. GENERATED by ir_table_gen.py, do not edit by hand.
+ * Entry i is the ADC code read with an object IR_TABLE_START_MM + i * IR_TABLE_STEP_MM away.
+**/
+
+#ifndef IR_TABLE_H_
+#define IR_TABLE_H_
+
+#include <stdint.h>
+#include "bot_callibration.h"
+
+#if CYBOT_ID == 23
+
+// CyBot 23: ir_calibration_bot23.csv, power law d = 517861 * (code - 532)^-1.10765, RMS error 4.3 mm over 21 points
+#define IR_TABLE_START_MM 100
+#define IR_TABLE_STEP_MM 10
+#define IR_TABLE_LEN 41
+#define IR_TABLE_SEARCH_STEP 32 // Largest power of two below IR_TABLE_LEN
+static const uint16_t IR_TABLE[IR_TABLE_LEN] = {
+    2787, 2601, 2445, 2312, 2197, 2096, 2008, 1929, 1859, 1795,
+    1738, 1686, 1639, 1595, 1555, 1518, 1484, 1452, 1422, 1395,
+    1369, 1344, 1321, 1300, 1279, 1260, 1242, 1224, 1208, 1192,
+    1177, 1163, 1149, 1136, 1124, 1112, 1101, 1090, 1079, 1069,
+    1059
+};
+
+#else
+#error "No IR calibration for this CYBOT_ID: collect one with ir_calibrate.py and re-run ir_table_gen.py"
+#endif
+
+#endif /* IR_TABLE_H_ */
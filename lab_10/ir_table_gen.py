@@ -0,0 +1,146 @@
+# Author: Thiago Bedal, Joseph Vesterby
+# Date: 11/24/2025
+# Description: Generates ir_table.h, the flash-resident IR distance lookup tables used by
+#              adc_calculateIRDistanceMM() in adc.c, from measured (distance, ADC code) pairs.
+#              Every ir_calibration_bot<ID>.csv next to this script becomes one table, and the
+#              firmware picks the one matching CYBOT_ID in bot_callibration.h at compile time.
+#
+#              By default each robot's data is least-squares fitted to a power law with an offset,
+#                  distance_mm = a * (adc_code - c0) ^ b
+#              (log-log linear regression for every candidate c0, keeping the one with the lowest
+#              RMS error). --fit piecewise skips the fit and interpolates the raw points instead.
+#
+# Usage: python ir_table_gen.py [--fit power|piecewise] [--step-mm 10] [--output ir_table.h]
+#
+# Collect new data with ir_calibrate.py, then re-run this and commit the regenerated header.
+
+import argparse
+import csv
+import glob
+import math
+import os
+import re
+
+
+# Read (distance in mm, ADC code) pairs, sorted by distance
+def read_calibration(path):
+        points = []
+        with open(path, newline="") as calibration_file:
+                for row in csv.DictReader(calibration_file):
+                        points.append((int(float(row["distance_cm"]) * 10), int(row["adc_code"])))
+        points.sort()
+        return points
+
+
+# Least-squares fit of ln(distance) = ln(a) + b * ln(code - c0) for a fixed offset c0
+def fit_power_law_at(points, offset):
+        xs = [math.log(code - offset) for distance, code in points]
+        ys = [math.log(distance) for distance, code in points]
+        mean_x = sum(xs) / len(xs)
+        mean_y = sum(ys) / len(ys)
+        b = sum((x - mean_x) * (y - mean_y) for x, y in zip(xs, ys)) / sum((x - mean_x) ** 2 for x in xs)
+        a = math.exp(mean_y - b * mean_x)
+        rms = math.sqrt(sum((a * (code - offset) ** b - distance) ** 2 for distance, code in points) / len(points))
+        return rms, a, b, offset
+
+
+# Try every offset below the smallest measured code and keep the best fit
+def fit_power_law(points):
+        lowest_code = min(code for distance, code in points)
+        return min(fit_power_law_at(points, offset) for offset in range(0, lowest_code, 4))
+
+
+# Linearly interpolate the ADC code at distance_mm from the measured points
+def code_at(points, distance_mm):
+        for (d0, c0), (d1, c1) in zip(points, points[1:]):
+                if d0 <= distance_mm <= d1:
+                        return round(c0 + (c1 - c0) * (distance_mm - d0) / (d1 - d0))
+        raise ValueError("distance " + str(distance_mm) + " mm is outside the calibration data")
+
+
+# Resample onto a uniform distance grid so the firmware can turn a table index straight into millimeters
+def build_table(points, step_mm, fit):
+        start_mm = points[0][0]
+        end_mm = points[-1][0]
+        distances = range(start_mm, end_mm + 1, step_mm)
+
+        if fit == "power":
+                rms, a, b, offset = fit_power_law(points)
+                codes = [round(offset + (d / a) ** (1 / b)) for d in distances]
+                note = "power law d = %.6g * (code - %d)^%.5f, RMS error %.1f mm over %d points" % (a, offset, b, rms, len(points))
+        else:
+                codes = [code_at(points, d) for d in distances]
+                note = "piecewise linear through %d points" % len(points)
+
+        # Search and interpolation in adc.c rely on codes strictly falling with distance
+        for near, far in zip(codes, codes[1:]):
+                if far >= near:
+                        raise ValueError("ADC codes must strictly decrease with distance (" + str(near) + " then " + str(far) + ")")
+
+        return start_mm, codes, note
+
+
+def table_block(robot_id, source, start_mm, step_mm, codes, note):
+        search_step = 1
+        while search_step * 2 < len(codes):
+                search_step *= 2
+
+        rows = []
+        for i in range(0, len(codes), 10):
+                rows.append("    " + ", ".join("%4d" % code for code in codes[i:i + 10]))
+
+        return ("// CyBot %d: %s, %s\n" % (robot_id, source, note) +
+                "#define IR_TABLE_START_MM %d\n" % start_mm +
+                "#define IR_TABLE_STEP_MM %d\n" % step_mm +
+                "#define IR_TABLE_LEN %d\n" % len(codes) +
+                "#define IR_TABLE_SEARCH_STEP %d // Largest power of two below IR_TABLE_LEN\n" % search_step +
+                "static const uint16_t IR_TABLE[IR_TABLE_LEN] = {\n" +
+                ",\n".join(rows) + "\n" +
+                "};\n")
+
+
+def write_header(path, blocks):
+        with open(path, "w") as header:
+                header.write("/**\n")
+                header.write(" * ir_table.h\n")
+                header.write(" *\n")
+                header.write(" * Per-robot IR distance lookup tables. GENERATED by ir_table_gen.py, do not edit by hand.\n")
+                header.write(" * Entry i is the ADC code read with an object IR_TABLE_START_MM + i * IR_TABLE_STEP_MM away.\n")
+                header.write("**/\n\n")
+                header.write("#ifndef IR_TABLE_H_\n#define IR_TABLE_H_\n\n")
+                header.write("#include <stdint.h>\n")
+                header.write("#include \"bot_callibration.h\"\n\n")
+
+                keyword = "#if"
+                for robot_id, block in blocks:
+                        header.write("%s CYBOT_ID == %d\n\n" % (keyword, robot_id))
+                        header.write(block + "\n")
+                        keyword = "#elif"
+
+                header.write("#else\n")
+                header.write("#error \"No IR calibration for this CYBOT_ID: collect one with ir_calibrate.py and re-run ir_table_gen.py\"\n")
+                header.write("#endif\n\n")
+                header.write("#endif /* IR_TABLE_H_ */\n")
+
+
+def main():
+        here = os.path.dirname(os.path.abspath(__file__))
+        parser = argparse.ArgumentParser(description="Generate ir_table.h from per-robot IR calibration data")
+        parser.add_argument("--output", default=os.path.join(here, "ir_table.h"))
+        parser.add_argument("--step-mm", type=int, default=10)
+        parser.add_argument("--fit", choices=["power", "piecewise"], default="power")
+        args = parser.parse_args()
+
+        blocks = []
+        for path in sorted(glob.glob(os.path.join(here, "ir_calibration_bot*.csv"))):
+                robot_id = int(re.search(r"bot(\d+)\.csv$", path).group(1))
+                start_mm, codes, note = build_table(read_calibration(path), args.step_mm, args.fit)
+                blocks.append((robot_id, table_block(robot_id, os.path.basename(path), start_mm, args.step_mm, codes, note)))
+                print("CyBot " + str(robot_id) + ": " + note)
+
+        blocks.sort()
+        write_header(args.output, blocks)
+        print("Wrote " + str(len(blocks)) + " table(s) to " + args.output)
+
+
+main()
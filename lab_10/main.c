@@ -21,6 +21,11 @@
 #include "ping.h"
 #include "servo.h"
 #include "button.h"
+#include "scan.h"
+#include "protocol.h"
+#include "filter.h"
+#include "segment.h"
+#include "map.h"
 
 
 /* <----------| DEFINITIONS |----------> */
@@ -33,27 +38,18 @@
 #define SCAN_END 180
 #define SCAN_INCREMENT 2
 #define NUM_SCANS (((SCAN_END - SCAN_START) / SCAN_INCREMENT) + 1)
-#define BUFFER_SIZE 10
+#define FILTER_WINDOW 5
 #define MAX_OBJECTS 15
-#define TOLERANCE 3
-#define NO_OBJECT_DISTANCE 50
 #define CRASH_AVOIDANCE_OFFSET 10
+#define NO_OBJECT_ANGLE 255 // findSmallestObject() found nothing it could measure
 
 // Initialization values
 #define BAUD_RATE 115200
+#define IR_SAMPLE_RATE_HZ 2000
 #define INIT_SERVO 0b0001
 #define INIT_PING 0b0010
 #define INIT_IR 0b0100
-
-// Wrapper struct for angle and distance values vector measured by the ultrasonic and IR sensors
-struct scanResultData {
-    uint8_t angle;
-    uint8_t pingDistance;
-    uint8_t irDistance;
-};
-
-// Prettier and faster way to type the way we're using our result data
-typedef struct scanResultData scanVector;
+#define IR_CAL_SAMPLES 64
 
 // TODO: use these for interrupts
 volatile char uart_data;
@@ -68,42 +64,20 @@ uint16_t servo_leftBound;
 
 /* <----------| UART METHODS |----------> */
 
-// Loop through array of distance values and print table of scanned angles
-void printScanData(scanVector vectors[], uint8_t numVectors);
-
 // Execute a certain movement action on the cybot based on user input
 int executeBotCommand(oi_t* sensor, scanVector vectors[], char input);
 
 // Sets bot into manual mode and until user exits
 void engageManualMode(oi_t* sensor, scanVector vectors[]);
 
-/* <----------| FIELD SCANNING METHODS |----------> */
-
-// Perform ultrasonic scan of field from startAngle to endAngle in incrementAngle increments, storing values in vectors array
-void scanField(uint8_t startAngle, uint8_t endAngle, uint8_t incrementAngle, scanVector vectors[]);
+// Guided IR calibration for ir_calibrate.py: each 'h' reports an averaged raw ADC code, 'x' exits
+void calibrateIR(void);
 
-// Filters noise in data by averaging values across a rolling average buffer. Generates new array, buffer-by-buffer
-void rollingAverageFilter(scanVector vectors[], uint8_t numValues, uint8_t bufferSize);
+/* <----------| FIELD SCANNING METHODS |----------> */
 
-// Finds the smallest object in a scan and returns the median angle at which it is located
+// Finds the smallest object in a scan and returns the median angle at which it is located, or NO_OBJECT_ANGLE
 uint8_t findSmallestObject(scanVector vectors[], uint8_t numValues);
 
-// Calcualte width of object based on sound vector values
-uint8_t calculateObjectWidth(uint8_t medianDistance, uint8_t startAngle, uint8_t endAngle);
-
-/* <----------| MATH & HELPER METHODS |----------> */
-
-// Returns a 1 if given value is within +/- tolerance of target, 0 if not
-uint8_t isWithinTolerance(uint8_t value, uint8_t target, uint8_t tolerance);
-
-// Returns the mean (average) of all values up to index length-1 in array
-uint8_t mean(uint8_t values[], uint8_t length);
-
-// Shifts all items to the left, remove first item, and appends newValue to length-1 index
-void updateBuffer(uint8_t buffer[], uint8_t length, uint8_t newValue);
-
-// TODO: comment me!
-scanVector scanAngle (uint8_t angle);
 
 /* <----------| IMPLEMENTATIONS |----------> */
 
@@ -117,16 +91,22 @@ uint8_t main(void)
     double smallestObjectDistance;
     double nextTurnDegrees;
     uint8_t smallestObjectAngle;
+    map_pose_t robotPose;
 
     // Initialize variables
     oi_init(sensor_data);
+    // Only what movement.c and the pose read (packets 7 and 39-44): 13 data bytes per poll instead of 80, 20 per stream frame instead of 81
+    oi_setQueryFields(OI_FIELD_BUMPS_DROPS | OI_FIELD_ENCODERS | OI_FIELD_REQUESTED);
+    oi_startStream();
     timer_init();
     adc_init();
+    adc_startContinuous(IR_SAMPLE_RATE_HZ);
     uart_init(BAUD_RATE);
     ping_init();
     servo_init();
     servo_rightBound = 49295;
     servo_leftBound = 21764;
+    map_init();
 
 
     // Uncomment and run to find cybot servo callibration values:
@@ -152,16 +132,29 @@ uint8_t main(void)
 
         /* <----------| STEP 1: SCAN FIELD |----------> */
 
-        // Perform scan across field and print raw distances and filter noise with rolling average
+        // Perform scan across field at full resolution (an adaptive scan can miss objects narrower than its coarse step)
+        // and median filter out sensor spikes
         scanField(SCAN_START, SCAN_END, SCAN_INCREMENT, measuredVectors);
-        rollingAverageFilter(measuredVectors, NUM_SCANS, BUFFER_SIZE);
+        filter_scan(measuredVectors, NUM_SCANS, FILTER_WINDOW, FILTER_KERNEL_MEDIAN, FILTER_FIELD_PING | FILTER_FIELD_IR | FILTER_FIELD_FUSED);
+
+        // Remember what this scan saw, placed at the odometry pose (start of the run is the middle of the map)
+        robotPose.xMM = (int16_t)oi_getPose()->x;
+        robotPose.yMM = (int16_t)oi_getPose()->y;
+        robotPose.headingDegrees = (int16_t)(oi_getPose()->heading * 180.0f / (float)M_PI);
+        map_addScan(measuredVectors, NUM_SCANS, &robotPose);
 
         // Find smallest object in filtered data
         smallestObjectAngle = findSmallestObject(measuredVectors, NUM_SCANS);
 
+        // Nothing whole in view (none found, or all cut off by the scan's edges), so there is nowhere to drive
+        if (smallestObjectAngle == NO_OBJECT_ANGLE) {
+            uart_sendStr("No object found. Press `h` to scan again.\r\n");
+            continue;
+        }
+
         // Point, turn, and drive to smallest object found
         servo_move(smallestObjectAngle);
-        smallestObjectDistance = (double)measuredVectors[smallestObjectAngle / SCAN_INCREMENT].pingDistance;
+        smallestObjectDistance = measuredVectors[smallestObjectAngle / SCAN_INCREMENT].fusedDistance / 10.0;
 
         // Notify client of scan results
         snprintf(puttyMessage, MAX_MESSAGE_LEN, "Wants to turn %u Degrees, then drive: %.1f cm. Press `h` to continue.\r\n", smallestObjectAngle, smallestObjectDistance);
@@ -212,138 +205,18 @@ uint8_t main(void)
     }
 }
 
-scanVector scanAngle(uint8_t angle) {
-    scanVector returnedVector;
-
-    // Move servo to input angle and store in degrees
-    servo_move((float)angle);
-    returnedVector.angle = angle;
-
-    // Scan and store ultrasound in centimeters (capped at 250cm)
-    uint8_t pingDistanceRaw = (uint8_t)ping_read();
-    returnedVector.pingDistance = pingDistanceRaw > 250.0 ? (uint8_t)(250) : (uint8_t)(pingDistanceRaw);
-
-    // Scan and store converted IR data in centimeters
-    returnedVector.irDistance = adc_calculateIRDistance(adc_read());
-
-    return returnedVector;
-}
-
-void printScanData(scanVector vectors[], uint8_t numVectors) {
-    char output[MAX_MESSAGE_LEN];
-    uint8_t i = 0;
-
-    // Print table header
-    uart_sendStr("Angle(Degrees)\tSound_Dist(cm)\tIR_Dist(cm)\r\n");
-
-    // Loop through values and print angle and distance to putty in table format
-    for (i = 0; i < numVectors; i++) {
-        snprintf(output, MAX_MESSAGE_LEN, "%u\t%u\t%u\r\n", vectors[i].angle, vectors[i].pingDistance, vectors[i].irDistance);
-        uart_sendStr(output);
-    }
-
-    uart_sendStr("END\n");
-}
-
-void scanField(uint8_t startAngle, uint8_t endAngle, uint8_t incrementAngle, scanVector vectors[]) {
-    uint8_t index = 0;
-    uint8_t angle = startAngle;
-
-    // Iterate through each angle in array (Chopped For loop)
-    while (angle <= endAngle) {
-        // Poll sensor and add value to array
-        vectors[index] = scanAngle(angle);
-
-        index += 1;
-        angle += incrementAngle;
-    }
-}
-
-uint8_t isWithinTolerance(uint8_t value, uint8_t target, uint8_t tolerance) {
-    return abs(value - target) < tolerance;
-}
-
-uint8_t mean(uint8_t values[], uint8_t length) {
-    uint8_t i = 0;
-    uint16_t total = 0;
-    for (i = 0; i < length; i++) {
-        total += values[i];
-    }
-    return total / length;
-}
-
-void updateBuffer(uint8_t buffer[], uint8_t length, uint8_t newValue) {
-    uint8_t i = 0;
-    for (i = 0; i < length - 1; i++) {
-        buffer[i] = buffer[i + 1];
-    }
-    buffer[length - 1] = newValue;
-}
-
-void rollingAverageFilter(scanVector vectors[], uint8_t numValues, uint8_t bufferSize) {
-    // Initialize variables
-    uint8_t buffer[BUFFER_SIZE];
-    uint8_t i = 0;
-    uint8_t j = 0;
-
-    // Fill buffer with first bufferSize items
-    for (i = 0; i < bufferSize; i++) {
-        updateBuffer(buffer, bufferSize, vectors[i].pingDistance);
-    }
-
-    // Generate values for new, filtered array up to the length - buffer size index
-    for (i = 0; i < numValues - bufferSize; i++) {
-        vectors[i].pingDistance = mean(buffer, bufferSize);
-        updateBuffer(buffer, bufferSize, vectors[i + bufferSize].pingDistance);
-    }
-
-    // Generate values for last bufferSize items. Theoretically unneccessary but I don't have the energy to FAAFO
-    for (i = numValues - bufferSize; i < numValues; i++) {
-        vectors[i].pingDistance = mean(buffer, bufferSize - j);
-        j++; // TODO: technically an unnecessary variable, but again, I want to slam my head into my desk rn and this works
-    }
-}
-
-// TODO: Make it not store PING data when it doesn't USE it
 uint8_t findSmallestObject(scanVector vectors[], uint8_t numValues) {
-    uint8_t index = 0;
-
-    // Find objects from data and record their start and end angles into the corresponding arrays
-    uint8_t objectStartAngles[MAX_OBJECTS], objectEndAngles[MAX_OBJECTS];
-    uint8_t currentDistance = 0, nextDistance = 0;
-    uint8_t objectCount = 0;
-    uint8_t lookingAtObject = 0;
-    for (index = 0; index < numValues - 1; index++) { // TODO: i'm aware i can probably incremment by two since i'm always checking the next value but i do not care
-        currentDistance = vectors[index].irDistance;
-        nextDistance = vectors[index + 1].irDistance;
-
-        // Found BEGINNING of NEW object if (NOT looking at object) AND (object is within range) AND (next value is within tolerance)
-        if ((!lookingAtObject) && (currentDistance < NO_OBJECT_DISTANCE) && (isWithinTolerance(currentDistance, nextDistance, TOLERANCE))) {
-            objectStartAngles[objectCount] = vectors[index].angle;
-            lookingAtObject = 1;
-        }
-        // Found END of CURRENT object if (looking at object) AND (object is within range) AND (next value is out of range)
-        else if ((lookingAtObject) && (currentDistance < NO_OBJECT_DISTANCE) && (nextDistance >= NO_OBJECT_DISTANCE)) {
-            objectEndAngles[objectCount] = vectors[index].angle;
-            lookingAtObject = 0;
-            objectCount++;
-        }
-    }
-
-    // Calculate true widths of each object and store the object with the smallest width
-    uint8_t currentWidth = 255, currentStartAngle = 255, currentEndAngle = 255;
-    uint8_t smallestWidth = 255, smallestDegree = 255;
-    for (index = 0; index < objectCount; index++) {
-        // Calculate width of object
-        currentStartAngle = objectStartAngles[index];
-        currentEndAngle = objectEndAngles[index];
-        currentDistance = vectors[(objectStartAngles[index] + objectEndAngles[index]) / (SCAN_INCREMENT * 2)].pingDistance; // divide by four because joe is better at math than me
-        currentWidth = calculateObjectWidth(currentDistance, currentStartAngle, currentEndAngle);
-
-        // Determine if current object is the smallest object
-        if (currentWidth < smallestWidth) {
-            smallestWidth = currentWidth;
-            smallestDegree = ((uint16_t)(currentStartAngle) + (uint16_t)(currentEndAngle)) / 2;
+    segment_object_t objects[MAX_OBJECTS];
+    uint8_t numObjects = segment_findObjects(vectors, numValues, objects, MAX_OBJECTS, NULL);
+    uint16_t smallestWidth = UINT16_MAX;
+    uint8_t smallestDegree = NO_OBJECT_ANGLE;
+    uint8_t index;
+
+    // Pick the narrowest object, ignoring ones cut off by the edge of the scan since their width is a guess
+    for (index = 0; index < numObjects; index++) {
+        if (!objects[index].clipped && objects[index].widthMM < smallestWidth) {
+            smallestWidth = objects[index].widthMM;
+            smallestDegree = objects[index].centerAngle;
         }
     }
 
@@ -351,10 +224,6 @@ uint8_t findSmallestObject(scanVector vectors[], uint8_t numValues) {
     return smallestDegree;
 }
 
-uint8_t calculateObjectWidth(uint8_t medianDistance, uint8_t startAngle, uint8_t endAngle) {
-    return sqrt(((pow(medianDistance, 2)) * 2) * (1 - cos(((endAngle - startAngle) / 180.0) * M_PI)));
-}
-
 int executeBotCommand(oi_t* sensor, scanVector vectors[], char input) {
     oi_update(sensor);
 
@@ -364,12 +233,14 @@ int executeBotCommand(oi_t* sensor, scanVector vectors[], char input) {
         case 's': bot_drive(-BOT_MAX_SPEED); break;
         case 'a': bot_turn(BOT_TURN_SPEED); break;
         case 'd': bot_turn(-BOT_TURN_SPEED); break;
-        case 'm': scanField(SCAN_START, SCAN_END, SCAN_INCREMENT, vectors); printScanData(vectors, NUM_SCANS); break;
+        case 'm': scanFieldStreaming(SCAN_START, SCAN_END, SCAN_INCREMENT, vectors); break;
+        case 'n': protocol_sendScan(vectors, scanFieldContinuous(SCAN_START, SCAN_END, SCAN_INCREMENT, vectors)); break;
         case ' ': bot_stopWheels(); break;
         case '3': bot_driveSquare(sensor); break;
         case '4': bot_driveObstacles(sensor, 200); break;
         case 'q': bot_turnDegrees(sensor, BOT_TURN_SPEED, 5.0); break;
         case 'e': bot_turnDegrees(sensor, BOT_TURN_SPEED, -5.0); break;
+        case 'c': calibrateIR(); break;
         default:
             // Command not recognized
             return 0;
@@ -406,3 +277,29 @@ void engageManualMode(oi_t* sensor, scanVector vectors[]) {
 
     return;
 }
+
+void calibrateIR(void) {
+    char output[MAX_MESSAGE_LEN];
+    char input = 0;
+    uint32_t sum;
+    uint8_t i;
+
+    servo_move(90);
+    uart_sendStr("CAL READY\r\n");
+
+    // Report one averaged code per request, the client pairs it with the distance it measured
+    while ((input = uart_getChar()) != 'x') {
+        if (input != 'h') { continue; }
+
+        sum = 0;
+        for (i = 0; i < IR_CAL_SAMPLES; i++) {
+            sum += adc_read();
+            timer_waitMillis(1);
+        }
+
+        snprintf(output, MAX_MESSAGE_LEN, "CAL\t%u\r\n", (unsigned int)((sum + IR_CAL_SAMPLES / 2) / IR_CAL_SAMPLES));
+        uart_sendStr(output);
+    }
+
+    uart_sendStr("CAL DONE\r\n");
+}
@@ -0,0 +1,143 @@
+/**
+ * map.c
+ *
+ * Contains a persistent occupancy grid that every field scan is fused into
+ * 
+ * @date November 26, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include "map.h"
+#include "trig.h"
+
+/* <----------| DEFINES |----------> */
+
+#define MAP_HALF_SIZE_MM (MAP_SIZE_CELLS * MAP_CELL_MM / 2)
+#define MAP_NUM_BYTES (MAP_SIZE_CELLS * MAP_SIZE_CELLS / 2)
+
+/* <----------| PRIVATE GLOBALS |----------> */
+
+// Two cells per byte, even cell index in the low nibble
+static uint8_t grid[MAP_NUM_BYTES];
+
+/* <----------| PRIVATE METHODS |----------> */
+
+// value * q15 / 32768, rounded to nearest so ray ends land in the right cell
+static int32_t map_scaleQ15(int32_t value, int16_t q15);
+
+// Cell index along one axis for a map coordinate in mm, rounding down so points off the map stay off it
+static int16_t map_cellIndex(int32_t mm);
+
+// Converts a map coordinate in mm to a cell index, returns false if it falls outside the map
+static bool map_toCell(int32_t xMM, int32_t yMM, int16_t *column, int16_t *row);
+
+// Adds delta to the cell's log-odds, clamped to 0..MAP_MAX_ODDS
+static void map_adjustCell(int16_t column, int16_t row, int8_t delta);
+
+// Walks the cells from (x0, y0) to (x1, y1) lowering each, then raises the last one if hit is set.
+// Stops early at the edge of the map
+static void map_traceRay(int16_t x0, int16_t y0, int16_t x1, int16_t y1, bool hit);
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+void map_init(void) {
+    uint16_t i;
+
+    for (i = 0; i < MAP_NUM_BYTES; i++) {
+        grid[i] = (MAP_UNKNOWN << 4) | MAP_UNKNOWN;
+    }
+}
+
+void map_addScan(const scanVector vectors[], uint8_t numVectors, const map_pose_t *pose) {
+    int32_t sensorX = pose->xMM + map_scaleQ15(MAP_SENSOR_OFFSET_MM, trig_cosQ15(2 * pose->headingDegrees));
+    int32_t sensorY = pose->yMM + map_scaleQ15(MAP_SENSOR_OFFSET_MM, trig_sinQ15(2 * pose->headingDegrees));
+    int16_t startColumn, startRow, endColumn, endRow;
+    int32_t rayHalfDegrees, range, endX, endY;
+    bool hit;
+    uint8_t i;
+
+    if (!map_toCell(sensorX, sensorY, &startColumn, &startRow)) { return; }
+
+    for (i = 0; i < numVectors; i++) {
+        // Trust a return only if a sensor actually saw something within range
+        hit = vectors[i].fusedVariance != SCAN_VARIANCE_UNKNOWN && vectors[i].fusedDistance <= MAP_MAX_RANGE_MM;
+        range = hit ? vectors[i].fusedDistance : MAP_NO_RETURN_FREE_MM;
+
+        rayHalfDegrees = 2 * ((int32_t)pose->headingDegrees + vectors[i].angle - 90);
+        endX = sensorX + map_scaleQ15(range, trig_cosQ15(rayHalfDegrees));
+        endY = sensorY + map_scaleQ15(range, trig_sinQ15(rayHalfDegrees));
+
+        // Cell coordinates of the endpoint even if it is off the map, the trace stops at the edge by itself
+        endColumn = map_cellIndex(endX);
+        endRow = map_cellIndex(endY);
+
+        map_traceRay(startColumn, startRow, endColumn, endRow, hit);
+    }
+}
+
+uint8_t map_getCell(int16_t xMM, int16_t yMM) {
+    int16_t column, row;
+    uint16_t cell;
+
+    if (!map_toCell(xMM, yMM, &column, &row)) { return MAP_UNKNOWN; }
+
+    cell = (uint16_t)row * MAP_SIZE_CELLS + column;
+    return (cell & 1) ? grid[cell >> 1] >> 4 : grid[cell >> 1] & 0x0F;
+}
+
+bool map_isOccupied(int16_t xMM, int16_t yMM) {
+    return map_getCell(xMM, yMM) >= MAP_OCCUPIED_THRESHOLD;
+}
+
+static int32_t map_scaleQ15(int32_t value, int16_t q15) {
+    int32_t product = value * q15;
+    return (product + (product < 0 ? -(1 << 14) : (1 << 14))) / 32768;
+}
+
+static int16_t map_cellIndex(int32_t mm) {
+    int32_t shifted = mm + MAP_HALF_SIZE_MM;
+    return (int16_t)(shifted >= 0 ? shifted / MAP_CELL_MM : (shifted - (MAP_CELL_MM - 1)) / MAP_CELL_MM);
+}
+
+static bool map_toCell(int32_t xMM, int32_t yMM, int16_t *column, int16_t *row) {
+    *column = map_cellIndex(xMM);
+    *row = map_cellIndex(yMM);
+    return *column >= 0 && *column < MAP_SIZE_CELLS && *row >= 0 && *row < MAP_SIZE_CELLS;
+}
+
+static void map_adjustCell(int16_t column, int16_t row, int8_t delta) {
+    uint16_t cell = (uint16_t)row * MAP_SIZE_CELLS + column;
+    uint8_t shift = (cell & 1) ? 4 : 0;
+    int8_t value = ((grid[cell >> 1] >> shift) & 0x0F) + delta;
+
+    if (value < 0) { value = 0; }
+    if (value > MAP_MAX_ODDS) { value = MAP_MAX_ODDS; }
+
+    grid[cell >> 1] = (grid[cell >> 1] & ~(0x0F << shift)) | (value << shift);
+}
+
+static void map_traceRay(int16_t x0, int16_t y0, int16_t x1, int16_t y1, bool hit) {
+    int16_t dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int16_t dy = y1 > y0 ? y0 - y1 : y1 - y0; // Negative, as in the all-octant form of Bresenham
+    int8_t stepX = x0 < x1 ? 1 : -1;
+    int8_t stepY = y0 < y1 ? 1 : -1;
+    int16_t error = dx + dy;
+    int16_t doubled;
+
+    while (x0 >= 0 && x0 < MAP_SIZE_CELLS && y0 >= 0 && y0 < MAP_SIZE_CELLS) {
+        if (x0 == x1 && y0 == y1) {
+            map_adjustCell(x0, y0, hit ? MAP_HIT_STEP : -MAP_MISS_STEP);
+            return;
+        }
+
+        // Everything the ray passes through before its end is free space
+        map_adjustCell(x0, y0, -MAP_MISS_STEP);
+
+        doubled = 2 * error;
+        if (doubled >= dy) { error += dy; x0 += stepX; }
+        if (doubled <= dx) { error += dx; y0 += stepY; }
+    }
+}
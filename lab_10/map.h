@@ -0,0 +1,64 @@
+/**
+ * map.h
+ *
+ * Contains a persistent occupancy grid that every field scan is fused into, so the CyBot remembers what it saw
+ * before it moved
+ *
+ * The grid is MAP_SIZE_CELLS x MAP_SIZE_CELLS cells of MAP_CELL_MM, centered on where the bot was at map_init().
+ * Each cell holds a 4-bit log-odds value packed two to a byte (20 KB for a 4 x 4 m arena at 2 cm): MAP_UNKNOWN
+ * is even odds, every ray that passes through a cell lowers it by MAP_MISS_STEP, and the cell a ray ends on goes
+ * up by MAP_HIT_STEP. Rays are walked with integer Bresenham, so an update costs one pass over the cells crossed.
+ *
+ * Map frame: x and y in mm, heading in degrees counter-clockwise from +x, the same frame as oi_getPose().
+ * 
+ * @date November 26, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+#ifndef MAP_H_
+#define MAP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "scan.h"
+
+#define MAP_CELL_MM 20
+#define MAP_SIZE_CELLS 200
+
+// Log-odds encoding of a cell (0 = surely free, 15 = surely occupied)
+#define MAP_UNKNOWN 8
+#define MAP_MAX_ODDS 15
+#define MAP_HIT_STEP 3
+#define MAP_MISS_STEP 1
+
+// A cell at or above this counts as an obstacle for map_isOccupied()
+#define MAP_OCCUPIED_THRESHOLD 11
+
+// Longest range trusted as a hit; returns past this (and PING timeouts) only clear up to MAP_NO_RETURN_FREE_MM
+#define MAP_MAX_RANGE_MM 2500
+#define MAP_NO_RETURN_FREE_MM 1000
+
+// Distance from the bot's center of rotation to the servo-mounted sensors, along the heading
+#define MAP_SENSOR_OFFSET_MM 120
+
+// Where the bot is on the map
+typedef struct {
+    int16_t xMM;
+    int16_t yMM;
+    int16_t headingDegrees;
+} map_pose_t;
+
+// Clears every cell to MAP_UNKNOWN, the current bot position becomes the center of the map
+void map_init(void);
+
+// Fuses every ray of a scan taken at pose. Scan angle 90 is straight ahead, 0 is to the bot's right
+void map_addScan(const scanVector vectors[], uint8_t numVectors, const map_pose_t *pose);
+
+// Log-odds value of the cell containing (xMM, yMM), MAP_UNKNOWN outside the map
+uint8_t map_getCell(int16_t xMM, int16_t yMM);
+
+// Returns true if the cell containing (xMM, yMM) is at or above MAP_OCCUPIED_THRESHOLD
+bool map_isOccupied(int16_t xMM, int16_t yMM);
+
+#endif /* MAP_H_ */
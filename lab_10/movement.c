@@ -12,6 +12,14 @@
 
 #include "movement.h"
 
+/* <----------| PRIVATE METHODS |----------> */
+
+// Sends batch (NULL for none) with the sensor update, then waits for data newer than the last update. A streamed
+// update returns at once, so without this every loop pass would finish in microseconds and re-send its wheel
+// command far faster than the Create refreshes its sensors. Gives up after BOT_SENSOR_TIMEOUT_MILLIS, with
+// distance and angle left at 0
+static oi_status_t bot_update(oi_t *sensor, oi_batch_t *batch);
+
 /* <----------| IMPLEMENTATIONS |----------> */
 
 int bot_isBumped(oi_t *sensor) {
@@ -24,14 +32,14 @@ void bot_drive(int velocity) {
 
 double bot_driveDistance(oi_t *sensor, int velocity, double distanceCM) {
     // Initialize variables
-    oi_update(sensor);
+    bot_update(sensor, NULL);
     double desiredDistanceMM = distanceCM * 10;
     double distanceTraveledMM = 0;
 
     // Drive forward until desired distance is reached
     bot_drive(velocity);
     while (distanceTraveledMM < desiredDistanceMM && !(sensor -> bumpLeft || sensor -> bumpRight )) {
-        oi_update(sensor);
+        bot_update(sensor, NULL);
         if      (velocity > 0) { distanceTraveledMM += sensor -> distance; }
         else if (velocity < 0) { distanceTraveledMM -= sensor -> distance; }
         else { return 0.0; }
@@ -50,16 +58,17 @@ double bot_driveDistancePrecise(oi_t *sensor, int velocity, double distanceCM) {
     const int RAMP_DOWN_COEFFICIENT = 40;
 
     // Initialize variables
-    oi_update(sensor);
+    bot_update(sensor, NULL);
     double distanceTraveledMM = 0.0;
     int velocitySet = (sensor -> requestedRightVelocity);
     int direction = velocity < 0 ? -1 : 1;
+    oi_batch_t batch;
 
-    // Ramp up to desired velocity linearly
+    // Ramp up to desired velocity linearly, each new speed goes out in the same transfer as the sensor query
     while (!bot_isBumped(sensor) && abs(velocitySet) < abs(velocity) && abs(distanceTraveledMM) < CRUISING_DISTANCE_MM) {
-        bot_drive(velocitySet);
-
-        oi_update(sensor);
+        oi_batchBegin(&batch);
+        oi_batchWheels(&batch, velocitySet, velocitySet);
+        bot_update(sensor, &batch);
         distanceTraveledMM += sensor -> distance;
 
         velocitySet += RAMP_UP_COEFFICIENT * direction;
@@ -68,15 +77,15 @@ double bot_driveDistancePrecise(oi_t *sensor, int velocity, double distanceCM) {
     // Cruise until within 30 cm of total distance
     bot_drive(velocity);
     while (!bot_isBumped(sensor) && abs(distanceTraveledMM) < CRUISING_DISTANCE_MM) {
-        oi_update(sensor);
+        bot_update(sensor, NULL);
         distanceTraveledMM += sensor -> distance;
     }
 
     // Ramp down to crawl speed
     while (!bot_isBumped(sensor) && abs(velocitySet) > BOT_CRAWL_SPEED) {
-        bot_drive(velocitySet);
-
-        oi_update(sensor);
+        oi_batchBegin(&batch);
+        oi_batchWheels(&batch, velocitySet, velocitySet);
+        bot_update(sensor, &batch);
         distanceTraveledMM += sensor -> distance;
 
         velocitySet -= RAMP_DOWN_COEFFICIENT * direction;
@@ -84,7 +93,7 @@ double bot_driveDistancePrecise(oi_t *sensor, int velocity, double distanceCM) {
 
     // Drive slowly until desired distance reached
     while (!bot_isBumped(sensor) && abs(distanceTraveledMM) < DESIRED_DISTANCE_MM) {
-        oi_update(sensor);
+        bot_update(sensor, NULL);
         distanceTraveledMM += sensor -> distance;
     }
 
@@ -125,7 +134,7 @@ void bot_turn(int velocity) {
 
 void bot_turnDegrees(oi_t *sensor, int velocity, double degrees) {
     // Initialize variables
-    oi_update(sensor);
+    bot_update(sensor, NULL);
     double degreesTurned = 0.0;
 
     // Tank turn left for +degrees; tank turn right for -degrees
@@ -134,7 +143,7 @@ void bot_turnDegrees(oi_t *sensor, int velocity, double degrees) {
 
     // Continue turning until desired degrees reached
     while (abs(degreesTurned) < abs(degrees) - 0.1) { // TODO: do we need this absolute value here?
-        oi_update(sensor);
+        bot_update(sensor, NULL);
         degreesTurned += sensor -> angle;
     }
     bot_stopWheels();
@@ -143,3 +152,22 @@ void bot_turnDegrees(oi_t *sensor, int velocity, double degrees) {
 void bot_stopWheels(void) {
     oi_setWheels(0, 0);
 }
+
+static oi_status_t bot_update(oi_t *sensor, oi_batch_t *batch) {
+    uint32_t startMillis = timer_getMillis();
+    oi_status_t status;
+    oi_batch_t empty;
+
+    if (batch == NULL) {
+        oi_batchBegin(&empty);
+        batch = &empty;
+    }
+
+    // Polling paces itself on the Create's update period; streaming has to wait here for the next frame
+    status = oi_updateBatch(sensor, batch);
+    while (status == OI_STATUS_NO_FRAME && timer_getMillis() - startMillis < BOT_SENSOR_TIMEOUT_MILLIS) {
+        status = oi_update(sensor);
+    }
+
+    return status;
+}
@@ -18,6 +18,7 @@
 #define BOT_CRUISE_SPEED 200
 #define BOT_CRAWL_SPEED 50
 #define BOT_TURN_SPEED 50
+#define BOT_SENSOR_TIMEOUT_MILLIS 40 // Longest a loop waits for fresh sensor data, a bit over two stream frames
 
 // Returns 1 if robot has been bumped, 0 if not
 int bot_isBumped(oi_t *sensor);
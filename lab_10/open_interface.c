@@ -16,6 +16,7 @@
  */
 
 #include "open_interface.h"
+#include "dma.h"
 
 #define OI_OPCODE_START 128
 #define OI_OPCODE_BAUD 129
@@ -82,9 +83,131 @@
 
 #define SENSOR_PACKET_SIZE 80
 
+// Odometry geometry (per datasheet): 508.8 encoder ticks per revolution of a 72 mm wheel, 235 mm wheel base
+#define OI_MM_PER_TICK (72.0f * (float)M_PI / 508.8f)
+#define OI_WHEEL_BASE_MM 235.0f
+
+// Sensor stream framing: [OI_STREAM_HEADER][length][packet ID][data...][checksum], all bytes sum to 0 mod 256
+#define OI_STREAM_HEADER 19
+#define OI_STREAM_MAX_LEN 96
+#define OI_STREAM_PERIOD_MILLIS 15
+#define OI_REQUEST_GAP_MILLIS 15 // The Create refreshes its sensors every 15 ms, asking sooner only re-reads old data
+#define OI_REPLY_TIMEOUT_MILLIS 20 // All 80 bytes of group 100 take 7 ms at 115200, anything past this is lost
+#define OI_DMA_ENCODING_UART4_TX 2 // Channel 19's UART4 TX mapping (datasheet table 9-1)
+#define OI_STREAM_GAP_MILLIS 2 // Bytes in a reply are 87 us apart, a pause this long means the Create is done sending
+#define OI_UART4_NVIC_BIT (1 << (60 - 32)) // UART4 is interrupt 60
+#define OI_FIRMWARE_TIMEOUT_MILLIS 5000 // Longest oi_checkFirmware() waits for the reset banner to get to the version
+
+// Below this heading change (radians) an update is integrated as a straight line, the arc formula divides by it
+#define OI_POSE_MIN_ARC 1e-4f
+
+// Where each packet of group 100 sits in its 80-byte reply, and which oi_t fields it feeds
+typedef struct {
+    uint8_t id;
+    uint8_t offset;
+    uint8_t size;
+    uint16_t fields;
+} oi_packetInfo_t;
+
+static const oi_packetInfo_t OI_PACKETS[] = {
+    {  7,  0, 1, OI_FIELD_BUMPS_DROPS },
+    {  8,  1, 1, OI_FIELD_WALL },
+    {  9,  2, 1, OI_FIELD_CLIFFS },
+    { 10,  3, 1, OI_FIELD_CLIFFS },
+    { 11,  4, 1, OI_FIELD_CLIFFS },
+    { 12,  5, 1, OI_FIELD_CLIFFS },
+    { 13,  6, 1, OI_FIELD_VIRTUAL_WALL },
+    { 14,  7, 1, OI_FIELD_OVERCURRENTS },
+    { 15,  8, 1, OI_FIELD_DIRT },
+    { 17, 10, 1, OI_FIELD_INFRARED },
+    { 18, 11, 1, OI_FIELD_BUTTONS },
+    { 21, 16, 1, OI_FIELD_BATTERY },
+    { 22, 17, 2, OI_FIELD_BATTERY },
+    { 23, 19, 2, OI_FIELD_BATTERY },
+    { 24, 21, 1, OI_FIELD_BATTERY },
+    { 25, 22, 2, OI_FIELD_BATTERY },
+    { 26, 24, 2, OI_FIELD_BATTERY },
+    { 27, 26, 2, OI_FIELD_WALL },
+    { 28, 28, 2, OI_FIELD_CLIFFS },
+    { 29, 30, 2, OI_FIELD_CLIFFS },
+    { 30, 32, 2, OI_FIELD_CLIFFS },
+    { 31, 34, 2, OI_FIELD_CLIFFS },
+    { 34, 39, 1, OI_FIELD_OI_STATE },
+    { 35, 40, 1, OI_FIELD_OI_STATE },
+    { 36, 41, 1, OI_FIELD_OI_STATE },
+    { 37, 42, 1, OI_FIELD_OI_STATE },
+    { 38, 43, 1, OI_FIELD_OI_STATE },
+    { 39, 44, 2, OI_FIELD_REQUESTED },
+    { 40, 46, 2, OI_FIELD_REQUESTED },
+    { 41, 48, 2, OI_FIELD_REQUESTED },
+    { 42, 50, 2, OI_FIELD_REQUESTED },
+    { 43, 52, 2, OI_FIELD_ENCODERS },
+    { 44, 54, 2, OI_FIELD_ENCODERS },
+    { 45, 56, 1, OI_FIELD_LIGHT_BUMPERS },
+    { 46, 57, 2, OI_FIELD_LIGHT_BUMPERS },
+    { 47, 59, 2, OI_FIELD_LIGHT_BUMPERS },
+    { 48, 61, 2, OI_FIELD_LIGHT_BUMPERS },
+    { 49, 63, 2, OI_FIELD_LIGHT_BUMPERS },
+    { 50, 65, 2, OI_FIELD_LIGHT_BUMPERS },
+    { 51, 67, 2, OI_FIELD_LIGHT_BUMPERS },
+    { 52, 69, 1, OI_FIELD_INFRARED },
+    { 53, 70, 1, OI_FIELD_INFRARED },
+    { 54, 71, 2, OI_FIELD_MOTOR_CURRENTS },
+    { 55, 73, 2, OI_FIELD_MOTOR_CURRENTS },
+    { 56, 75, 2, OI_FIELD_MOTOR_CURRENTS },
+    { 57, 77, 2, OI_FIELD_MOTOR_CURRENTS },
+    { 58, 79, 1, OI_FIELD_STASIS }
+};
+
+#define OI_NUM_PACKETS (sizeof(OI_PACKETS) / sizeof(OI_PACKETS[0]))
+
+// The whole group as one entry, used when every field is wanted or a list would be no smaller
+static const oi_packetInfo_t OI_GROUP100 = { OI_SENSOR_PACKET_GROUP100, 0, SENSOR_PACKET_SIZE, OI_FIELD_ALL };
+
+// Packets oi_update() asks for, in the order they arrive
+static const oi_packetInfo_t *queryList[OI_NUM_PACKETS] = { &OI_GROUP100 };
+static uint8_t queryCount = 1;
+static uint8_t queryBytes = SENSOR_PACKET_SIZE;
+
+// Last reply of every packet laid out as group 100, so oi_parsePacket() works unchanged on partial updates
+static uint8_t sensorImage[SENSOR_PACKET_SIZE];
+
 float motor_cal_factor_L = 1.00;
 float motor_cal_factor_R = 1.00;
 
+// Dead-reckoned pose and the encoder counts it was last integrated from
+static oi_pose_t pose = { 0.0f, 0.0f, 0.0f };
+static int16_t poseLeftCount = 0;
+static int16_t poseRightCount = 0;
+static uint8_t posePrimed = 0;
+
+// Stream parser states, one byte of a frame each
+typedef enum {
+    OI_STREAM_WAIT_HEADER,
+    OI_STREAM_WAIT_LENGTH,
+    OI_STREAM_DATA,
+    OI_STREAM_CHECKSUM
+} oi_streamState_t;
+
+// Two frame buffers: the ISR fills one while streamLatest names the last complete one
+static volatile uint8_t streamFrames[2][OI_STREAM_MAX_LEN];
+static volatile uint8_t streamLatest = 0;
+static volatile oi_stats_t stats;
+
+// Bytes of the batch the uDMA is sending, kept here so callers can build the next one on the stack meanwhile
+static uint8_t batchTx[OI_BATCH_MAX];
+static uint8_t streamLength = 0;     // Length byte the configured stream sends, anything else is not a header
+static uint8_t streaming = 0;
+static oi_streamState_t parseState = OI_STREAM_WAIT_HEADER;
+static uint8_t parseSlot = 0;
+static uint8_t parseIndex = 0;
+static uint8_t parseSum = 0;
+static uint32_t consumedFrames = 0;  // stats.frames as of the last frame oi_updateBatch() handed out
+
+// Polling pace and receive error counts
+static uint32_t lastRequestMicros = 0;
+static uint8_t requestSent = 0;
+
 /// Initialize the iRobot open interface without updating a struct
 /// internal function
 void oi_init_noupdate(void);
@@ -108,6 +231,24 @@ void uart_sendStr(const char *theData);
 ///	internal function
 char oi_uartReceive(void);
 
+/// Read one byte from the UART4 data register, counting any receive error flagged with it
+///	internal function
+static uint8_t oi_uartReadData(void);
+
+/// Read up to length bytes, draining the RX FIFO a burst at a time, until they are all in or timeoutMillis
+/// passes. Returns how many arrived
+///	internal function
+static uint8_t oi_uartReceiveBurst(uint8_t buffer[], uint8_t length, uint32_t timeoutMillis);
+
+/// Discard received bytes until the line has been quiet for OI_STREAM_GAP_MILLIS, so a late or partial reply
+/// is not read as the start of the next one
+///	internal function
+static void oi_uartFlush(void);
+
+/// Wait out what is left of OI_REQUEST_GAP_MILLIS since the last sensor request that actually went out
+///	internal function
+static void oi_paceRequest(void);
+
 /// Parse data from iRobot into oi_t struct
 void oi_parsePacket(oi_t *self, uint8_t packet[]);
 
@@ -115,6 +256,36 @@ void oi_parsePacket(oi_t *self, uint8_t packet[]);
 ///	internal function
 void oi_uartSendBuff(const uint8_t theData[], uint8_t theSize);
 
+/// Copy each queried packet from a reply into sensorImage. Stream frames carry each packet's ID in front of it;
+/// returns false if those do not match the query list
+///	internal function
+static uint8_t oi_scatterPackets(const uint8_t data[], uint8_t withIds);
+
+/// Encoders shared by the per-call senders and the oi_batch* builders so both put out the same bytes. Each writes
+/// one command to out and returns its length
+///	internal function
+static uint8_t oi_encodeWheels(uint8_t out[], int16_t right_wheel, int16_t left_wheel);
+static uint8_t oi_encodeLeds(uint8_t out[], uint8_t play_led, uint8_t advance_led, uint8_t power_color, uint8_t power_intensity);
+static uint8_t oi_encodeSong(uint8_t out[], int song_index, int num_notes, unsigned char *notes, unsigned char *duration);
+static uint8_t oi_encodePlaySong(uint8_t out[], int index);
+static uint8_t oi_encodeQuery(uint8_t out[]);
+
+/// Reserve room for a command at the end of a batch, or flag the batch as overflowed and return NULL
+///	internal function
+static uint8_t *oi_batchReserve(oi_batch_t *batch, uint8_t size);
+
+/// Send the stream command for the current query list
+///	internal function
+static void oi_sendStreamList(void);
+
+/// Feed one received byte to the stream parser
+///	internal function
+static void oi_streamParse(uint8_t data);
+
+/// Integrate the encoder change since the last update into the pose
+///	internal function
+static void oi_updatePose(oi_t *self);
+
 /// Helper function to convert big-endian integer from pointer into little
 /// endian integer
 /// internal function
@@ -172,26 +343,280 @@ void oi_close()
 }
 
 /// Update all sensor and store in oi_t struct
-void oi_update(oi_t *self)
+oi_status_t oi_update(oi_t *self)
 {
-    uint8_t sensorBuffer[SENSOR_PACKET_SIZE];
+    oi_batch_t batch;
 
-    // Query list of sensors
-    oi_uartSendChar(OI_OPCODE_SENSORS);
-    oi_uartSendChar(OI_SENSOR_PACKET_GROUP100);
+    oi_batchBegin(&batch);
+    return oi_updateBatch(self, &batch);
+}
 
-    // Read all the sensor data
-    uint8_t i;
-    for (i = 0; i < SENSOR_PACKET_SIZE; i++) {
-        // read each sensor byte
-        sensorBuffer[i] = oi_uartReceive();
+oi_status_t oi_updateBatch(oi_t *self, oi_batch_t *batch)
+{
+    uint8_t sensorBuffer[OI_STREAM_MAX_LEN];
+    uint32_t frames;
+
+    // Streaming: snapshot the newest frame with the parser held off for the copy
+    if (streaming) {
+        oi_batchSubmit(batch);
+
+        NVIC_DIS1_R = OI_UART4_NVIC_BIT;
+        frames = stats.frames;
+        memcpy(sensorBuffer, (const uint8_t *)streamFrames[streamLatest], streamLength);
+        NVIC_EN1_R = OI_UART4_NVIC_BIT;
+
+        // Nothing new since the last call, so callers looping on this wait for the next frame instead of spinning
+        if (frames == consumedFrames) {
+            self->distance = 0;
+            self->angle = 0;
+            return OI_STATUS_NO_FRAME;
+        }
+        consumedFrames = frames;
+
+        if (!oi_scatterPackets(sensorBuffer, 1)) {
+            self->distance = 0;
+            self->angle = 0;
+            return OI_STATUS_NO_FRAME;
+        }
+        oi_parsePacket(self, sensorImage);
+        return OI_STATUS_OK;
+    }
+
+    // Query list of sensors behind the caller's commands, all in one transfer (no point waiting for a batch
+    // that will be refused). Only a request that went out starts the next gap
+    oi_batchQuery(batch);
+    if (!batch->overflow) {
+        oi_paceRequest();
+    }
+    if (!oi_batchSubmit(batch)) {
+        self->distance = 0;
+        self->angle = 0;
+        return OI_STATUS_OVERFLOW;
+    }
+    lastRequestMicros = timer_getMicros();
+    requestSent = 1;
+
+    // Read all the sensor data, a lost byte costs this update rather than hanging the robot
+    if (oi_uartReceiveBurst(sensorBuffer, queryBytes, OI_REPLY_TIMEOUT_MILLIS) < queryBytes) {
+        stats.timeouts++;
+        oi_uartFlush();
+        self->distance = 0;
+        self->angle = 0;
+        return OI_STATUS_TIMEOUT;
     }
 
     // Parse the sensor data into the struct
-    oi_parsePacket(self, sensorBuffer);
+    oi_scatterPackets(sensorBuffer, 0);
+    oi_parsePacket(self, sensorImage);
+    return OI_STATUS_OK;
+}
+
+static void oi_paceRequest(void)
+{
+    // Microseconds: whole milliseconds read on either side of a tick can be up to 1 ms short of the real gap
+    uint32_t elapsed = timer_getMicros() - lastRequestMicros;
 
-    timer_waitMillis(25); // reduces USART errors that occur when continuously
-                          // transmitting/receiving min wait time=15ms
+    if (requestSent && elapsed < OI_REQUEST_GAP_MILLIS * 1000) {
+        timer_waitMicros(OI_REQUEST_GAP_MILLIS * 1000 - elapsed);
+    }
+}
+
+
+void oi_setQueryFields(uint16_t fields)
+{
+    uint8_t count = 0;
+    uint8_t bytes = 0;
+    uint8_t i;
+
+    // Every packet feeding a requested field, in ID order
+    for (i = 0; i < OI_NUM_PACKETS; i++) {
+        if (OI_PACKETS[i].fields & fields) {
+            queryList[count++] = &OI_PACKETS[i];
+            bytes += OI_PACKETS[i].size;
+        }
+    }
+
+    // One ID per packet goes out with the request (and comes back in stream frames), group 100 wins past that
+    if (count + bytes >= 1 + SENSOR_PACKET_SIZE) {
+        queryList[0] = &OI_GROUP100;
+        count = 1;
+        bytes = SENSOR_PACKET_SIZE;
+    }
+
+    queryCount = count;
+    queryBytes = bytes;
+
+    // A running stream has to be told about the new list, and the parser about the new frame length. Frames
+    // already buffered in the old layout fail the ID check in oi_scatterPackets() rather than being misread
+    if (streaming) {
+        NVIC_DIS1_R = OI_UART4_NVIC_BIT;
+        streamLength = queryCount + queryBytes;
+        parseState = OI_STREAM_WAIT_HEADER;
+        NVIC_EN1_R = OI_UART4_NVIC_BIT;
+        oi_sendStreamList();
+    }
+}
+
+uint8_t oi_getQueryBytes(void)
+{
+    return queryBytes;
+}
+
+static uint8_t oi_scatterPackets(const uint8_t data[], uint8_t withIds)
+{
+    uint8_t i;
+
+    for (i = 0; i < queryCount; i++) {
+        if (withIds && *data++ != queryList[i]->id) {
+            return 0;
+        }
+        memcpy(sensorImage + queryList[i]->offset, data, queryList[i]->size);
+        data += queryList[i]->size;
+    }
+
+    return 1;
+}
+
+static void oi_sendStreamList(void)
+{
+    uint8_t i;
+
+    oi_uartSendChar(OI_OPCODE_STREAM);
+    oi_uartSendChar(queryCount);
+    for (i = 0; i < queryCount; i++) {
+        oi_uartSendChar(queryList[i]->id);
+    }
+}
+
+void oi_startStream(void)
+{
+    streamLength = queryCount + queryBytes; // One ID byte in front of each packet
+    stats.frames = 0;
+    stats.checksumErrors = 0;
+    stats.resyncs = 0;
+    consumedFrames = 0;
+    parseState = OI_STREAM_WAIT_HEADER;
+
+    // Interrupt when the RX FIFO passes half full, or when bytes have sat in it for 32 bit times
+    UART4_ICR_R = UART_ICR_RXIC | UART_ICR_RTIC;
+    UART4_IM_R |= UART_IM_RXIM | UART_IM_RTIM;
+    IntRegister(INT_UART4, oi_uartHandler);
+    NVIC_EN1_R = OI_UART4_NVIC_BIT;
+    IntMasterEnable();
+    streaming = 1;
+
+    oi_sendStreamList();
+}
+
+void oi_stopStream(void)
+{
+    // Pause the stream, then let any frame already on the wire finish so polling starts clean
+    oi_uartSendChar(OI_OPCODE_DO_STREAM);
+    oi_uartSendChar(0);
+    timer_waitMillis(OI_STREAM_PERIOD_MILLIS);
+
+    streaming = 0;
+    UART4_IM_R &= ~(UART_IM_RXIM | UART_IM_RTIM);
+    NVIC_DIS1_R = OI_UART4_NVIC_BIT;
+
+    oi_uartFlush();
+}
+
+oi_stats_t oi_getStats(void)
+{
+    oi_stats_t copy;
+
+    NVIC_DIS1_R = OI_UART4_NVIC_BIT;
+    memcpy(&copy, (const oi_stats_t *)&stats, sizeof(copy));
+    if (streaming) {
+        NVIC_EN1_R = OI_UART4_NVIC_BIT;
+    }
+
+    return copy;
+}
+
+void oi_uartHandler(void)
+{
+    uint32_t status = UART4_MIS_R;
+
+    // A finished oi_batchSubmit() transfer raises this vector too, and its UDMACHIS bit stays set until cleared
+    if (!dma_isChannelEnabled(DMA_CHANNEL_UART4_TX)) {
+        dma_clearInterrupt(DMA_CHANNEL_UART4_TX);
+    }
+
+    // Drain everything that has arrived, then clear the interrupt
+    while (!(UART4_FR_R & UART_FR_RXFE)) {
+        oi_streamParse(oi_uartReadData());
+    }
+    UART4_ICR_R = UART_ICR_RXIC | UART_ICR_RTIC;
+
+    // The receive timeout fires once the line has been idle for 32 bit times with bytes still waiting, so it
+    // marks the end of a burst. Each frame is one burst: ending mid-frame means bytes were lost, so hunt for the
+    // next header instead of swallowing it as data. A burst whose last byte went out with an RX interrupt raises
+    // no timeout; the length and checksum still catch that frame
+    if ((status & UART_MIS_RTMIS) && parseState != OI_STREAM_WAIT_HEADER) {
+        parseState = OI_STREAM_WAIT_HEADER;
+        stats.resyncs++;
+    }
+}
+
+/**
+ * @brief Stream parser state machine. A frame is only accepted if its length byte
+ * matches the configured stream and its checksum is good; anything else drops back
+ * to hunting for a header. Together with the receive-timeout reset in oi_uartHandler(), a
+ * corrupted or lost byte costs at most the frame it was in.
+ *
+ * @param data next received byte
+ */
+static void oi_streamParse(uint8_t data)
+{
+    switch (parseState) {
+        case OI_STREAM_WAIT_HEADER:
+            if (data == OI_STREAM_HEADER) {
+                parseSum = data;
+                parseState = OI_STREAM_WAIT_LENGTH;
+            }
+            else {
+                stats.resyncs++;
+            }
+            break;
+
+        case OI_STREAM_WAIT_LENGTH:
+            if (data == streamLength) {
+                parseSum += data;
+                parseIndex = 0;
+                parseState = OI_STREAM_DATA;
+            }
+            else {
+                // A 19 inside the data was taken for a header; this byte may itself be the real one
+                stats.resyncs++;
+                parseSum = data;
+                parseState = data == OI_STREAM_HEADER ? OI_STREAM_WAIT_LENGTH : OI_STREAM_WAIT_HEADER;
+            }
+            break;
+
+        case OI_STREAM_DATA:
+            streamFrames[parseSlot][parseIndex++] = data;
+            parseSum += data;
+            if (parseIndex == streamLength) {
+                parseState = OI_STREAM_CHECKSUM;
+            }
+            break;
+
+        case OI_STREAM_CHECKSUM:
+            parseSum += data;
+            if (parseSum == 0) {
+                // Publish this buffer and fill the other one next
+                streamLatest = parseSlot;
+                parseSlot ^= 1;
+                stats.frames++;
+            }
+            else {
+                stats.checksumErrors++;
+            }
+            parseState = OI_STREAM_WAIT_HEADER;
+            break;
+    }
 }
 
 void oi_parsePacket(oi_t *self, uint8_t packet[])
@@ -287,6 +712,55 @@ void oi_parsePacket(oi_t *self, uint8_t packet[])
 
     self->distance = oi_getDistance(self);
     self->angle = oi_getDegrees(self);
+
+    oi_updatePose(self);
+}
+
+/**
+ * @brief Integrates the wheel travel since the previous packet into the global pose.
+ * Encoder counts are free-running int16s, so the difference is taken modulo 2^16,
+ * which stays correct across a wrap as long as a wheel moves under 32768 ticks
+ * (about 14 m) between updates. Each step is integrated as the arc a differential
+ * drive follows with constant wheel speeds rather than a straight segment.
+ *
+ * @param self Sensor data pointer
+ */
+static void oi_updatePose(oi_t *self)
+{
+    int16_t leftTicks = (int16_t)(uint16_t)(self->leftEncoderCount - poseLeftCount);
+    int16_t rightTicks = (int16_t)(uint16_t)(self->rightEncoderCount - poseRightCount);
+    float leftMM, rightMM, center, turn, radius, heading;
+
+    poseLeftCount = self->leftEncoderCount;
+    poseRightCount = self->rightEncoderCount;
+
+    // The first packet only gives us a reference count
+    if (!posePrimed) {
+        posePrimed = 1;
+        return;
+    }
+
+    leftMM = leftTicks * OI_MM_PER_TICK;
+    rightMM = rightTicks * OI_MM_PER_TICK;
+    center = (leftMM + rightMM) / 2.0f;
+    turn = (rightMM - leftMM) / OI_WHEEL_BASE_MM;
+
+    if (fabsf(turn) < OI_POSE_MIN_ARC) {
+        pose.x += center * cosf(pose.heading);
+        pose.y += center * sinf(pose.heading);
+    }
+    else {
+        // Chord of a circle of radius center / turn swept through turn radians
+        radius = center / turn;
+        heading = pose.heading + turn;
+        pose.x += radius * (sinf(heading) - sinf(pose.heading));
+        pose.y -= radius * (cosf(heading) - cosf(pose.heading));
+    }
+
+    heading = pose.heading + turn;
+    if (heading > (float)M_PI) { heading -= 2.0f * (float)M_PI; }
+    else if (heading <= -(float)M_PI) { heading += 2.0f * (float)M_PI; }
+    pose.heading = heading;
 }
 
 inline int16_t oi_parseInt(uint8_t *theInt)
@@ -300,32 +774,50 @@ inline int16_t oi_parseInt(uint8_t *theInt)
 /// \param power_color (0-255), 0=green, 255=red
 /// \param power_intensity (0-255) 0=off, 255=full intensity
 void oi_setLeds(uint8_t play_led, uint8_t advance_led, uint8_t power_color, uint8_t power_intensity)
+{
+    uint8_t command[4];
+
+    oi_uartSendBuff(command, oi_encodeLeds(command, play_led, advance_led, power_color, power_intensity));
+}
+
+static uint8_t oi_encodeLeds(uint8_t out[], uint8_t play_led, uint8_t advance_led, uint8_t power_color, uint8_t power_intensity)
 {
     // LED Opcode
-    oi_uartSendChar(OI_OPCODE_LEDS);
+    out[0] = OI_OPCODE_LEDS;
 
     // Set the Play and Advance LEDs
-    oi_uartSendChar(advance_led << 3 && play_led << 2);
+    out[1] = advance_led << 3 && play_led << 2;
 
     // Set the power led color
-    oi_uartSendChar(power_color);
+    out[2] = power_color;
 
     // Set the power led intensity
-    oi_uartSendChar(power_intensity);
+    out[3] = power_intensity;
+
+    return 4;
 }
 
 /// \brief Set direction and speed of the robot's wheels
 /// \param linear velocity in mm/s values range from -500 -> 500 of right wheel
 /// \param linear velocity in mm/s values range from -500 -> 500 of left wheel
 void oi_setWheels(int16_t right_wheel, int16_t left_wheel)
+{
+    uint8_t command[5];
+
+    oi_uartSendBuff(command, oi_encodeWheels(command, right_wheel, left_wheel));
+}
+
+static uint8_t oi_encodeWheels(uint8_t out[], int16_t right_wheel, int16_t left_wheel)
 {
     right_wheel = right_wheel * motor_cal_factor_R;
     left_wheel = left_wheel * motor_cal_factor_L;
-    oi_uartSendChar(OI_OPCODE_DRIVE_WHEELS);
-    oi_uartSendChar(right_wheel >> 8);
-    oi_uartSendChar(right_wheel & 0xff);
-    oi_uartSendChar(left_wheel >> 8);
-    oi_uartSendChar(left_wheel & 0xff);
+    out[0] = OI_OPCODE_DRIVE_WHEELS;
+    out[1] = right_wheel >> 8;
+    out[2] = right_wheel & 0xff;
+    out[3] = left_wheel >> 8;
+    out[4] = left_wheel & 0xff;
+
+    return 5;
 }
 
 /// \brief Load song sequence
@@ -334,21 +826,166 @@ void oi_setWheels(int16_t right_wheel, int16_t left_wheel)
 /// sequence \param A pointer to a sequence of notes stored as integer values
 /// \param A pointer to a sequence of durations that correspond to the notes
 void oi_loadSong(int song_index, int num_notes, unsigned char *notes, unsigned char *duration)
+{
+    uint8_t command[3 + 2 * OI_SONG_MAX_NOTES];
+
+    oi_uartSendBuff(command, oi_encodeSong(command, song_index, num_notes, notes, duration));
+}
+
+static uint8_t oi_encodeSong(uint8_t out[], int song_index, int num_notes, unsigned char *notes, unsigned char *duration)
 {
     int i;
-    oi_uartSendChar(OI_OPCODE_SONG);
-    oi_uartSendChar(song_index);
-    oi_uartSendChar(num_notes);
+
+    // The Create only takes 16 notes, never write past a 16 note buffer
+    if (num_notes > OI_SONG_MAX_NOTES) {
+        num_notes = OI_SONG_MAX_NOTES;
+    }
+    else if (num_notes < 0) {
+        num_notes = 0;
+    }
+
+    out[0] = OI_OPCODE_SONG;
+    out[1] = song_index;
+    out[2] = num_notes;
     for (i = 0; i < num_notes; i++) {
-        oi_uartSendChar(notes[i]);
-        oi_uartSendChar(duration[i]);
+        out[3 + 2 * i] = notes[i];
+        out[4 + 2 * i] = duration[i];
     }
+
+    return 3 + 2 * num_notes;
 }
 
 /// Plays a given song; use oi_load_song(...) first
 void oi_play_song(int index) {
-    oi_uartSendChar(OI_OPCODE_PLAY);
-    oi_uartSendChar(index);
+    uint8_t command[2];
+
+    oi_uartSendBuff(command, oi_encodePlaySong(command, index));
+}
+
+static uint8_t oi_encodePlaySong(uint8_t out[], int index)
+{
+    out[0] = OI_OPCODE_PLAY;
+    out[1] = index;
+
+    return 2;
+}
+
+static uint8_t oi_encodeQuery(uint8_t out[])
+{
+    uint8_t i;
+
+    // The whole group, or just the packets asked for
+    if (queryList[0] == &OI_GROUP100) {
+        out[0] = OI_OPCODE_SENSORS;
+        out[1] = OI_SENSOR_PACKET_GROUP100;
+        return 2;
+    }
+
+    out[0] = OI_OPCODE_QUERY_LIST;
+    out[1] = queryCount;
+    for (i = 0; i < queryCount; i++) {
+        out[2 + i] = queryList[i]->id;
+    }
+
+    return 2 + queryCount;
+}
+
+void oi_batchBegin(oi_batch_t *batch)
+{
+    batch->length = 0;
+    batch->overflow = 0;
+}
+
+static uint8_t *oi_batchReserve(oi_batch_t *batch, uint8_t size)
+{
+    uint8_t *slot;
+
+    if (batch->overflow || batch->length + size > OI_BATCH_MAX) {
+        batch->overflow = 1;
+        return NULL;
+    }
+
+    slot = batch->data + batch->length;
+    batch->length += size;
+    return slot;
+}
+
+void oi_batchWheels(oi_batch_t *batch, int16_t right_wheel, int16_t left_wheel)
+{
+    uint8_t *slot = oi_batchReserve(batch, 5);
+
+    if (slot) {
+        oi_encodeWheels(slot, right_wheel, left_wheel);
+    }
+}
+
+void oi_batchLeds(oi_batch_t *batch, uint8_t play_led, uint8_t advance_led, uint8_t power_color, uint8_t power_intensity)
+{
+    uint8_t *slot = oi_batchReserve(batch, 4);
+
+    if (slot) {
+        oi_encodeLeds(slot, play_led, advance_led, power_color, power_intensity);
+    }
+}
+
+void oi_batchSong(oi_batch_t *batch, int song_index, int num_notes, unsigned char *notes, unsigned char *duration)
+{
+    uint8_t command[3 + 2 * OI_SONG_MAX_NOTES];
+    uint8_t length = oi_encodeSong(command, song_index, num_notes, notes, duration);
+    uint8_t *slot = oi_batchReserve(batch, length);
+
+    if (slot) {
+        memcpy(slot, command, length);
+    }
+}
+
+void oi_batchPlaySong(oi_batch_t *batch, int index)
+{
+    uint8_t *slot = oi_batchReserve(batch, 2);
+
+    if (slot) {
+        oi_encodePlaySong(slot, index);
+    }
+}
+
+void oi_batchQuery(oi_batch_t *batch)
+{
+    uint8_t *slot = oi_batchReserve(batch, queryList[0] == &OI_GROUP100 ? 2 : 2 + queryCount);
+
+    if (slot) {
+        oi_encodeQuery(slot);
+    }
+}
+
+uint8_t oi_batchSubmit(const oi_batch_t *batch)
+{
+    if (batch->overflow || batch->length == 0) {
+        return 0;
+    }
+
+    // The previous batch still reads batchTx until its channel disarms
+    oi_batchWait();
+    dma_clearInterrupt(DMA_CHANNEL_UART4_TX);
+    memcpy(batchTx, batch->data, batch->length);
+
+    // Byte at a time into UART4's TX FIFO, which requests a burst of 4 whenever it is at most half full
+    dma_setTransfer(DMA_CHANNEL_UART4_TX, false, (volatile void *)batchTx, &UART4_DR_R,
+                    UDMA_CHCTL_DSTINC_NONE | UDMA_CHCTL_DSTSIZE_8 | UDMA_CHCTL_SRCINC_8 | UDMA_CHCTL_SRCSIZE_8 |
+                    UDMA_CHCTL_ARBSIZE_4 | UDMA_CHCTL_XFERMODE_BASIC, batch->length);
+    dma_enableChannel(DMA_CHANNEL_UART4_TX);
+
+    return 1;
+}
+
+uint8_t oi_batchBusy(void)
+{
+    return dma_isChannelEnabled(DMA_CHANNEL_UART4_TX);
+}
+
+void oi_batchWait(void)
+{
+    while (dma_isChannelEnabled(DMA_CHANNEL_UART4_TX))
+        ; // the controller disarms the channel once the last byte is in the FIFO
 }
 
 /// Runs default go charge program; robot will search for dock
@@ -395,16 +1032,23 @@ void oi_uartInit(void)
     UART4_IBRD_R = iBRD;
     UART4_FBRD_R = fBRD;
 
-    UART4_LCRH_R = UART_LCRH_WLEN_8; // 8 bit, 1 stop, no parity, no FIFO
+    UART4_LCRH_R = UART_LCRH_WLEN_8 | UART_LCRH_FEN; // 8 bit, 1 stop, no parity, 16 byte FIFOs
     UART4_CC_R = UART_CC_CS_SYSCLK;  // Use System Clock
     UART4_CTL_R = UART_CTL_RXE | UART_CTL_TXE |
                   UART_CTL_UARTEN; // Enable Rx, Tx and UART module
+
+    // TX uDMA for oi_batchSubmit(), idle until a batch arms the channel
+    dma_init();
+    dma_configureChannel(DMA_CHANNEL_UART4_TX, OI_DMA_ENCODING_UART4_TX);
+    UART4_DMACTL_R |= UART_DMACTL_TXDMAE;
 }
 
 /// transmit character
 ///	internal function
 void oi_uartSendChar(char data)
 {
+    oi_batchWait(); // keeps bytes in order behind a batch the uDMA is still sending
+
     while ((UART4_FR_R & UART_FR_TXFF) != 0); // holds until no data in transmit buffer
 
     UART4_DR_R = data; // puts data in transmission buffer
@@ -415,19 +1059,60 @@ void oi_uartSendChar(char data)
 
 char oi_uartReceive(void)
 {
-    static int count = 0;
-    // uint32_t tempData; //used for error checking
-    char data;
+    uint8_t data = 0;
 
-    while ((UART4_FR_R & UART_FR_RXFE))
-        ; // wait here until data is recieved
+    // 0 if nothing arrived in time
+    if (oi_uartReceiveBurst(&data, 1, OI_REPLY_TIMEOUT_MILLIS) == 0) {
+        stats.timeouts++;
+    }
 
-    data = (char)(UART4_DR_R & 0xFF);
+    return (char)data;
+}
 
-    count++;
+static uint8_t oi_uartReceiveBurst(uint8_t buffer[], uint8_t length, uint32_t timeoutMillis)
+{
+    uint32_t start = timer_getMillis();
+    uint8_t count = 0;
+
+    while (count < length) {
+        // Take everything already in the FIFO before looking at the clock again
+        while (count < length && !(UART4_FR_R & UART_FR_RXFE)) {
+            buffer[count++] = oi_uartReadData();
+        }
+
+        if (count < length && timer_getMillis() - start >= timeoutMillis) {
+            break;
+        }
+    }
 
-    // ToDo: Implement error checking
-    return data;
+    return count;
+}
+
+static void oi_uartFlush(void)
+{
+    uint32_t quietSince = timer_getMillis();
+
+    while (timer_getMillis() - quietSince < OI_STREAM_GAP_MILLIS) {
+        if (!(UART4_FR_R & UART_FR_RXFE)) {
+            (void)oi_uartReadData();
+            quietSince = timer_getMillis();
+        }
+    }
+}
+
+static uint8_t oi_uartReadData(void)
+{
+    uint32_t data = UART4_DR_R; // error flags sit above the data byte
+
+    if (data & (UART_DR_FE | UART_DR_PE | UART_DR_BE | UART_DR_OE)) {
+        if (data & UART_DR_FE) { stats.framingErrors++; }
+        if (data & UART_DR_PE) { stats.parityErrors++; }
+        if (data & UART_DR_BE) { stats.breakErrors++; }
+        if (data & UART_DR_OE) { stats.overruns++; }
+        UART4_ECR_R = 0; // clear the latched copy in UARTRSR
+    }
+
+    return (uint8_t)(data & 0xFF);
 }
 
 /// transmit character array
@@ -456,28 +1141,43 @@ char *oi_checkFirmware()
 
     static char firmware[21];
 
-    char buffer[512];
-    uint16_t ptr;
+    char window[sizeof(FIRM_STR)]; // Last FIRM_STRLEN characters of the banner
+    uint8_t ptr = 0;
+    uint8_t found = 0;
+    uint32_t start;
+    char c;
 
     // Reset the iRobot
     oi_uartSendChar(OI_OPCODE_RESET);
+    start = timer_getMillis();
 
-    char c;
-    while ((c = oi_uartReceive()) || 1) {
-        buffer[ptr++] = c;
-
-        // Do a string compare
-        buffer[ptr] = '\0';
-        if (ptr >= FIRM_STRLEN &&
-            !strcmp(buffer + ptr - FIRM_STRLEN, FIRM_STR)) {
-            ptr = 0;
-            // Firmware version incoming
-            while ((c = oi_uartReceive()) != FIRM_END) {
-                firmware[ptr++] = c;
-            }
+    // Slide along the banner until the tag prefix goes past. Receives that time out (the banner pauses, or the
+    // Create is not there) only cost time, and the whole search gives up at the deadline
+    while (!found && timer_getMillis() - start < OI_FIRMWARE_TIMEOUT_MILLIS) {
+        if (!oi_uartReceiveBurst((uint8_t *)&c, 1, OI_REPLY_TIMEOUT_MILLIS)) {
+            continue;
+        }
 
+        if (ptr == FIRM_STRLEN) {
+            memmove(window, window + 1, FIRM_STRLEN - 1);
+            ptr--;
+        }
+        window[ptr++] = c;
+        window[ptr] = '\0';
+
+        found = ptr == FIRM_STRLEN && !strcmp(window, FIRM_STR);
+    }
+
+    // Firmware version incoming, up to FIRM_END, as much as fits and arrives in time
+    ptr = 0;
+    while (found && ptr < sizeof(firmware) - 1 && timer_getMillis() - start < OI_FIRMWARE_TIMEOUT_MILLIS) {
+        if (!oi_uartReceiveBurst((uint8_t *)&c, 1, OI_REPLY_TIMEOUT_MILLIS)) {
+            continue;
+        }
+        if (c == FIRM_END) {
             break;
         }
+        firmware[ptr++] = c;
     }
 
     firmware[ptr] = '\0';
@@ -626,3 +1326,24 @@ double oi_getMotorCalibrationLeft(void) { return motor_cal_factor_L; }
  */
 double oi_getMotorCalibrationRight(void) { return motor_cal_factor_R; }
 
+/**
+ * @brief Returns the dead-reckoned pose kept up to date by oi_update().
+ *
+ * @return pointer to the live pose, valid for the life of the program
+ */
+const oi_pose_t *oi_getPose(void) { return &pose; }
+
+/**
+ * @brief Overrides the current pose, e.g. to re-zero at a known landmark.
+ *
+ * @param x mm
+ * @param y mm
+ * @param heading radians counter-clockwise from +x
+ */
+void oi_setPose(float x, float y, float heading)
+{
+    pose.x = x;
+    pose.y = y;
+    pose.heading = heading;
+}
+
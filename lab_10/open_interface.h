@@ -129,6 +129,68 @@ typedef struct {
 
 } oi_t;
 
+/// oi_t field groups for oi_setQueryFields(), OR together the ones a program reads
+#define OI_FIELD_BUMPS_DROPS      0x0001 // bump*, wheelDrop*
+#define OI_FIELD_WALL             0x0002 // wallSensor, wallSignal
+#define OI_FIELD_CLIFFS           0x0004 // cliff*, cliff*Signal
+#define OI_FIELD_VIRTUAL_WALL     0x0008
+#define OI_FIELD_OVERCURRENTS     0x0010
+#define OI_FIELD_DIRT             0x0020
+#define OI_FIELD_INFRARED         0x0040 // infraredChar*
+#define OI_FIELD_BUTTONS          0x0080
+#define OI_FIELD_BATTERY          0x0100 // chargingState, battery*
+#define OI_FIELD_OI_STATE         0x0200 // chargingSourcesAvailable, oiMode, song*, numberOfStreamPackets
+#define OI_FIELD_REQUESTED        0x0400 // requested* velocities and radius
+#define OI_FIELD_ENCODERS         0x0800 // *EncoderCount, and through them distance, angle and the pose
+#define OI_FIELD_LIGHT_BUMPERS    0x1000 // lightBumper*, lightBump*Signal
+#define OI_FIELD_MOTOR_CURRENTS   0x2000
+#define OI_FIELD_STASIS           0x4000
+#define OI_FIELD_ALL              0x7FFF
+
+/// Longest run of commands one oi_batch_t holds: a full 16 note song plus drive, LEDs and play, or drive and LEDs
+/// ahead of the longest sensor query
+#define OI_BATCH_MAX 64
+#define OI_SONG_MAX_NOTES 16
+
+/// Several OI commands assembled in RAM, sent by oi_batchSubmit() in one uDMA transfer
+typedef struct {
+	uint8_t data[OI_BATCH_MAX];
+	uint8_t length;
+	uint8_t overflow;  // A command did not fit, oi_batchSubmit() refuses the batch rather than send half of it
+} oi_batch_t;
+
+/// Dead-reckoned pose of the robot, integrated from the wheel encoders on every oi_update()
+typedef struct {
+	float x;        // mm, +x is the way the robot faced at oi_init()
+	float y;        // mm, +y is to its left
+	float heading;  // radians counter-clockwise from +x, wrapped to (-pi, pi]
+} oi_pose_t;
+
+/// Health of the link to the Create
+typedef struct {
+	// Sensor stream started by oi_startStream(), cleared each time it starts
+	uint32_t frames;          // Frames that passed the checksum
+	uint32_t checksumErrors;  // Frames dropped for a bad checksum
+	uint32_t resyncs;         // Bytes skipped while hunting for the next frame header
+
+	// Receive errors the UART4 hardware flagged, counted per byte as it is read
+	uint32_t framingErrors;   // Stop bit missing, usually a baud mismatch or noise
+	uint32_t parityErrors;
+	uint32_t breakErrors;     // Line held low for a whole frame
+	uint32_t overruns;        // Bytes lost because the RX FIFO was full
+
+	// Polling
+	uint32_t timeouts;        // Replies that did not arrive in full before their deadline
+} oi_stats_t;
+
+/// Result of oi_update()
+typedef enum {
+	OI_STATUS_OK,         // oi_t holds fresh data
+	OI_STATUS_TIMEOUT,    // The reply never arrived in full, the link was flushed for the next request
+	OI_STATUS_NO_FRAME,   // Streaming, but no new frame matching the current query list since the last update
+	OI_STATUS_OVERFLOW    // oi_updateBatch() could not fit the sensor query in the batch, nothing was sent
+} oi_status_t;
+
 
 ///Allocate and clear all memory for OI Struct
 oi_t * oi_alloc();
@@ -142,8 +204,36 @@ void oi_init(oi_t *self);
 
 void oi_close();
 
-///Update sensor data
-void oi_update(oi_t *self);
+///Update sensor data. While streaming this only copies the newest frame, it never blocks, and a frame is only
+///returned once: until the next one arrives (every 15 ms) the result is OI_STATUS_NO_FRAME. When polling it only
+///waits for whatever is left of the Create's 15 ms update period since the previous request, and gives up on a
+///reply after 20 ms. Anything but OI_STATUS_OK leaves the sensors as they were and zeroes
+///distance/angle, so loops integrating those just see no motion for one update
+oi_status_t oi_update(oi_t *self);
+
+///Same as oi_update(), but the commands already in batch go out in the same uDMA transfer, right ahead of the
+///sensor query (while streaming there is no query, the batch is just submitted). batch is consumed either way
+oi_status_t oi_updateBatch(oi_t *self, oi_batch_t *batch);
+
+/// Chooses which oi_t fields oi_update() refreshes. The smallest list of packets covering them is requested
+/// (opcode 149, or the stream's list while streaming) instead of all 80 bytes of group 100; fields outside the
+/// mask keep whatever they last read. OI_FIELD_ALL (the default) goes back to group 100
+void oi_setQueryFields(uint16_t fields);
+
+/// Bytes of sensor data each oi_update() now transfers
+uint8_t oi_getQueryBytes(void);
+
+/// Has the Create push the oi_setQueryFields() packets every 15 ms (opcode 148), parsed by the UART4 RX interrupt
+void oi_startStream(void);
+
+/// Stops the stream and returns oi_update() to request/response polling
+void oi_stopStream(void);
+
+/// Counters for the stream parser, UART4 receive errors and polling timeouts
+oi_stats_t oi_getStats(void);
+
+/// UART4 RX interrupt, feeds the stream parser
+void oi_uartHandler(void);
 
 /// \brief Set the LEDS on the Create
 /// \param play_led 0=off, 1=on
@@ -169,10 +259,43 @@ void oi_loadSong(int song_index, int num_notes, unsigned char  *notes, unsigned
 /// \param An integer value from 0 - 15 that is a previously establish song index
 void oi_play_song(int index);
 
+/// \brief Empty a batch so commands can be appended to it
+void oi_batchBegin(oi_batch_t *batch);
+
+/// \brief Append the same bytes oi_setWheels() sends
+void oi_batchWheels(oi_batch_t *batch, int16_t right_wheel, int16_t left_wheel);
+
+/// \brief Append the same bytes oi_setLeds() sends
+void oi_batchLeds(oi_batch_t *batch, uint8_t play_led, uint8_t advance_led, uint8_t power_color, uint8_t power_intensity);
+
+/// \brief Append the same bytes oi_loadSong() sends
+void oi_batchSong(oi_batch_t *batch, int song_index, int num_notes, unsigned char *notes, unsigned char *duration);
+
+/// \brief Append the same bytes oi_play_song() sends
+void oi_batchPlaySong(oi_batch_t *batch, int index);
+
+/// \brief Append the sensor request oi_update() sends for the oi_setQueryFields() packets (opcode 149, or 142
+/// for group 100). The reply still has to be read, oi_updateBatch() does both
+void oi_batchQuery(oi_batch_t *batch);
+
+/// \brief Start sending a batch through uDMA and return at once. The bytes are copied out, so the batch can be
+/// reused or go out of scope straight away. Waits for a previous batch still in flight first, and every other
+/// OI transmit waits for this one, so commands always reach the Create in the order they were issued
+/// \return 0 if the batch overflowed or is empty and nothing was sent
+uint8_t oi_batchSubmit(const oi_batch_t *batch);
+
+/// \brief Returns 1 while a submitted batch is still being sent
+uint8_t oi_batchBusy(void);
+
+/// \brief Block until the last submitted batch has been handed to the UART
+void oi_batchWait(void);
+
 /// Calls in built in demo to send the iRobot to an open home base
 /// This will cause the iRobot to enter the Passive state
 void go_charge(void);
 
+/// Resets the Create and reads its firmware version (e.g. "release-3.8.3") out of the reset banner. Returns ""
+/// if the banner has not got that far within 5 s, and at most 20 characters of the version
 char* oi_checkFirmware();
 
 //initializes interrupt and gpio to handle button press to end OI
@@ -199,4 +322,10 @@ double oi_getMotorCalibrationLeft(void);
 // Gets the encoder calibration for the right encoder
 double oi_getMotorCalibrationRight(void);
 
+// Returns the current dead-reckoned pose, a pointer to the live struct so reading it costs nothing
+const oi_pose_t *oi_getPose(void);
+
+// Sets the current pose, the next oi_update() integrates from here
+void oi_setPose(float x, float y, float heading);
+
 #endif /* OPEN_INTERFACE_H_ */
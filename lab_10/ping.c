@@ -11,17 +11,37 @@
 /* <----------| INCLUDES |----------> */
 
 #include "ping.h"
+#include <math.h>
 
 /* <----------| DEFINES |----------> */
 
 volatile uint32_t positiveEdgeTime; // When sensor gives out pulse
 volatile uint32_t negativeEdgeTime; // When sensor recieves pulse
-volatile uint8_t doneFlag = 0; // 1 after end of pulse
+static volatile ping_status_t pingStatus = PING_STATUS_IDLE; // Updated by the ISR as the measurement progresses
+static volatile uint32_t pulseWidthTicks = 0; // Width of the last echo pulse
 volatile uint8_t firstFlag = 0; // Stores which pulse we're on so timer ISR updates proper time (ONLY FOR ISR)
 
-// ISR for caputring PING)) pulse uisng Timer 3B 
+static ping_callback_t pingCallback = 0;
+static uint16_t timeoutMicros = PING_DEFAULT_TIMEOUT_MICROS;
+
+// Speed-of-sound model and the ambient conditions it was last evaluated at
+static ping_soundModel_t soundModel = ping_defaultSoundModel;
+static int16_t ambientDeciCelsius = PING_DEFAULT_DECI_CELSIUS;
+static uint8_t ambientHumidity = PING_DEFAULT_HUMIDITY;
+static uint32_t speedOfSoundMMPerS = 343000;
+
+// One-way millimeters per 62.5 ns echo tick in Q24 fixed point (speed / 16 MHz / 2 * 2^24). Starts at 343 m/s
+static uint32_t mmPerTickQ24 = 179831;
+
+// Re-evaluates the sound model and refreshes speedOfSoundMMPerS and mmPerTickQ24
+static void ping_updateConversion(void);
+
+// ISR for caputring PING)) pulse uisng Timer 3B, and the echo timeout on Timer 3A
 static void ping_timerHandler(void);
 
+// Stops the timeout and edge capture, records the result and fires the callback (ONLY FOR ISR)
+static void ping_finish(ping_status_t status);
+
 /* <----------| IMPLEMENTATIONS |----------> */
 
 void ping_init(void) {
@@ -65,17 +85,44 @@ void ping_init(void) {
 
     TIMER3_IMR_R &= ~0b1'0000'1111'0001'1111;
 
+    // Timer 3A is the echo timeout: one-shot countdown, prescaler 15 gives 1 us ticks. Started by ping_start()
+    TIMER3_TAMR_R = 0b0001;
+    TIMER3_TAPR_R = 15;
+    TIMER3_TAILR_R = timeoutMicros - 1;
+    TIMER3_IMR_R |= 0b0001; // Timeout interrupt
+
     /* <----------| CONFIG INTERRUPTS |----------> */
 
     IntMasterEnable();
-    NVIC_EN1_R |= (0b1 << (36 - 32));
+    NVIC_EN1_R |= (0b1 << (35 - 32)) | (0b1 << (36 - 32));
+    IntRegister(INT_TIMER3A, ping_timerHandler);
     IntRegister(INT_TIMER3B, ping_timerHandler);
 
     TIMER3_CTL_R |= 0b000'0001'0000'0000;
+
+    ping_updateConversion();
 }
 
 double ping_read(void) {
-    double distanceCM = 0;
+    uint32_t pulseTicks = 0;
+    ping_status_t status;
+
+    ping_start();
+
+    // WAIT UNTIL SIGNAL DONE READING (bounded by the timeout)
+    while ((status = ping_poll(&pulseTicks)) == PING_STATUS_BUSY) {}
+
+    if (status != PING_STATUS_DONE) {
+        return PING_NO_ECHO_CM;
+    }
+
+    return ping_ticksToCentimeters(pulseTicks);
+}
+
+void ping_start(void) {
+    if (pingStatus == PING_STATUS_BUSY) {
+        return;
+    }
 
     /* <----------| PULSE OUT |----------> */
 
@@ -101,48 +148,143 @@ double ping_read(void) {
     // SET TO TIMER MODE
     GPIO_PORTB_AFSEL_R |= 0b0000'1000;
 
+    // RESET CAPTURE STATE
+    firstFlag = 0;
+    pulseWidthTicks = 0;
+    pingStatus = PING_STATUS_BUSY;
+
     // CLEAR INTERRUPTS
     TIMER3_ICR_R |= 0b1'0000'1111'0001'1111;
 
+    // ARM ECHO TIMEOUT
+    TIMER3_TAILR_R = timeoutMicros - 1;
+    TIMER3_CTL_R |= 0b0001;
+
     // UNMASK TIMER INTERRUPT
     TIMER3_IMR_R |= 0b0100'0000'0000;
+}
 
-    // WAIT UNTIL SIGNAL DONE READING
-    while (!doneFlag) {}
-
-    /* <----------| CALCULATE DISTANCE |----------> */
+ping_status_t ping_poll(uint32_t *pulseTicks) {
+    ping_status_t status = pingStatus;
 
-    // Multiply by periods to calculate time
-    if (positiveEdgeTime < negativeEdgeTime) {
-        positiveEdgeTime += 0xFFFFFF;
+    // Hand the finished result over exactly once
+    if (status == PING_STATUS_DONE || status == PING_STATUS_NO_ECHO) {
+        if (pulseTicks) {
+            *pulseTicks = pulseWidthTicks;
+        }
+        pingStatus = PING_STATUS_IDLE;
     }
 
-    // Calclates distance there and back using the speed of sound in cm/s ( /2 because we only care about the distance there)
-    distanceCM = (positiveEdgeTime - negativeEdgeTime) * 0.0000000625;
-    distanceCM *= (34300.0 / 2.0);
+    return status;
+}
 
-    // Reset flags
-    doneFlag = 0;
+void ping_setCallback(ping_callback_t callback) {
+    pingCallback = callback;
+}
+
+void ping_setTimeout(uint16_t micros) {
+    timeoutMicros = micros ? micros : 1;
+}
+
+double ping_ticksToCentimeters(uint32_t pulseTicks) {
+    // Calclates distance there and back using the speed of sound in cm/s ( /2 because we only care about the distance there)
+    double distanceCM = pulseTicks * 0.0000000625;
+    distanceCM *= (speedOfSoundMMPerS / 10.0 / 2.0);
 
     return distanceCM;
 }
 
+void ping_setAmbient(int16_t deciCelsius, uint8_t humidityPercent) {
+    ambientDeciCelsius = deciCelsius;
+    ambientHumidity = humidityPercent > 100 ? 100 : humidityPercent;
+    ping_updateConversion();
+}
+
+void ping_setSoundModel(ping_soundModel_t model) {
+    soundModel = model ? model : ping_defaultSoundModel;
+    ping_updateConversion();
+}
+
+uint32_t ping_defaultSoundModel(int16_t deciCelsius, uint8_t humidityPercent) {
+    // Only runs when conditions change, so a sqrt and exp here cost nothing per reading
+    double celsius = deciCelsius / 10.0;
+
+    // Mole fraction of water vapor: Magnus saturation pressure (Pa) scaled by humidity, over sea-level pressure
+    double vaporFraction = humidityPercent / 100.0 * 610.94 * exp(17.625 * celsius / (celsius + 243.04)) / 101325.0;
+
+    // Vapor is lighter than dry air, which speeds sound up by ~0.16x its mole fraction (ideal gas mixture)
+    double metersPerSecond = 331.3 * sqrt(1.0 + celsius / 273.15) * (1.0 + 0.16 * vaporFraction);
+
+    return (uint32_t)(metersPerSecond * 1000.0 + 0.5);
+}
+
+uint32_t ping_getSpeedOfSound(void) {
+    return speedOfSoundMMPerS;
+}
+
+uint32_t ping_readMillimeters(void) {
+    uint32_t pulseTicks = 0;
+    ping_status_t status;
+
+    ping_start();
+    while ((status = ping_poll(&pulseTicks)) == PING_STATUS_BUSY) {}
+
+    if (status != PING_STATUS_DONE) {
+        return PING_NO_ECHO_MM;
+    }
+
+    return ping_ticksToMillimeters(pulseTicks);
+}
+
+uint32_t ping_ticksToMillimeters(uint32_t pulseTicks) {
+    // Single 32x32->64 multiply and a shift instead of soft-float double math. Ticks are 24-bit so this can't overflow
+    return (uint32_t)(((uint64_t)(pulseTicks & 0xFFFFFF) * mmPerTickQ24 + (1UL << 23)) >> 24);
+}
+
+static void ping_updateConversion(void) {
+    speedOfSoundMMPerS = soundModel(ambientDeciCelsius, ambientHumidity);
+
+    // mm/s * 2^24 / (16 MHz * 2) == mm/s * 2^19 / 10^6, rounded
+    mmPerTickQ24 = (uint32_t)((((uint64_t)speedOfSoundMMPerS << 19) + 500000) / 1000000);
+}
+
 static void ping_timerHandler(void) {
-    // TODO: comment me!
+    // Timer 3A ran out: the echo never came back or never ended
+    if (TIMER3_MIS_R & 0b0001) {
+        TIMER3_ICR_R |= 0b0001;
+        ping_finish(PING_STATUS_NO_ECHO);
+        return;
+    }
 
     if (!(TIMER3_MIS_R & 0b0'0100'0000'0000)) {
         TIMER3_ICR_R |= 0b1'0000'1111'0001'1111;
         return;
     }
 
+    // First edge is the rising edge of the echo pulse, second is the falling edge
     if (!firstFlag) {
         positiveEdgeTime = TIMER3_TBR_R;
         firstFlag = 1;
     } else {
         negativeEdgeTime = TIMER3_TBR_R;
         firstFlag = 0;
-        doneFlag = 1;
+
+        // Timer counts down, so the pulse is first minus second edge. Masking to 24 bits handles the wrap
+        pulseWidthTicks = (positiveEdgeTime - negativeEdgeTime) & 0xFFFFFF;
+        ping_finish(PING_STATUS_DONE);
     }
 
     TIMER3_ICR_R |= 0b0'0100'0000'0000;
 }
+
+static void ping_finish(ping_status_t status) {
+    // STOP TIMEOUT AND MASK EDGE CAPTURE
+    TIMER3_CTL_R &= ~0b0001;
+    TIMER3_IMR_R &= ~0b0100'0000'0000;
+
+    pingStatus = status;
+
+    if (pingCallback) {
+        pingCallback(status, pulseWidthTicks);
+    }
+}
@@ -17,10 +17,71 @@
 #include "driverlib/interrupt.h"
 #include "Timer.h"
 
+// Echo timeout used until ping_setTimeout() is called. Covers the sensor's ~3 m max range (~18.5 ms) plus holdoff
+#define PING_DEFAULT_TIMEOUT_MICROS 20000
+
+// Distance ping_read() reports when no echo came back before the timeout
+#define PING_NO_ECHO_CM 300.0
+#define PING_NO_ECHO_MM 3000
+
+// Ambient conditions assumed until ping_setAmbient() is called (tenths of a degree C, % relative humidity)
+#define PING_DEFAULT_DECI_CELSIUS 200
+#define PING_DEFAULT_HUMIDITY 0
+
+// State of the current measurement, as reported by ping_poll() and the completion callback
+typedef enum {
+    PING_STATUS_IDLE,    // Nothing in flight
+    PING_STATUS_BUSY,    // Trigger sent, waiting on the echo
+    PING_STATUS_DONE,    // Echo captured, pulse width is valid
+    PING_STATUS_NO_ECHO  // Timed out before the echo pulse finished
+} ping_status_t;
+
+// Returns the speed of sound in mm/s for an ambient temperature in tenths of a degree C and relative humidity in %
+typedef uint32_t (*ping_soundModel_t)(int16_t deciCelsius, uint8_t humidityPercent);
+
+// Called from the Timer 3 ISR when a measurement finishes. pulseTicks is the echo width in 62.5 ns ticks (0 on no echo)
+typedef void (*ping_callback_t)(ping_status_t status, uint32_t pulseTicks);
+
 // Sets registers necessary for operating ultrasonic sensor
 void ping_init(void);
 
-// Sends out 5 us pulse and times length of pulse in to calculate distance from sensor in cm
+// Sends out 5 us pulse and times length of pulse in to calculate distance from sensor in cm. Returns PING_NO_ECHO_CM on timeout
 double ping_read(void);
 
+// Sends the trigger pulse and returns right away; the echo is timed by the Timer 3 ISR. Ignored if a measurement is in flight
+void ping_start(void);
+
+// Returns PING_STATUS_BUSY until the measurement finishes, then DONE or NO_ECHO once (storing the pulse width), then IDLE
+ping_status_t ping_poll(uint32_t *pulseTicks);
+
+// Registers a function to run from the ISR when each measurement finishes (NULL to disable)
+void ping_setCallback(ping_callback_t callback);
+
+// Sets how long to wait for the echo before reporting PING_STATUS_NO_ECHO (1 - 65535 us)
+void ping_setTimeout(uint16_t micros);
+
+// Converts an echo pulse width in timer ticks to a one-way distance in cm
+double ping_ticksToCentimeters(uint32_t pulseTicks);
+
+// Sets the ambient temperature (tenths of a degree C) and relative humidity (%) and recomputes the tick-to-mm
+// conversion factor from the current sound model. Readings pay nothing extra for compensation
+void ping_setAmbient(int16_t deciCelsius, uint8_t humidityPercent);
+
+// Swaps in a different speed-of-sound model (NULL restores ping_defaultSoundModel) and recomputes the conversion factor
+void ping_setSoundModel(ping_soundModel_t model);
+
+// Default model: ideal gas 331.3 m/s * sqrt(1 + T / 273.15) for dry air, sped up by the water vapor mole fraction the
+// relative humidity works out to at T. Within 0.15 m/s of an ideal-gas mixture over 0 - 40 C and 0 - 100 %
+uint32_t ping_defaultSoundModel(int16_t deciCelsius, uint8_t humidityPercent);
+
+// Returns the speed of sound currently used for conversions, in mm/s
+uint32_t ping_getSpeedOfSound(void);
+
+// Integer version of ping_read(). Returns PING_NO_ECHO_MM on timeout
+uint32_t ping_readMillimeters(void);
+
+// Converts an echo pulse width in timer ticks to a one-way distance in mm without floating point.
+// Within 1 mm of the exact double result over the whole 24-bit tick range, including a 0xFFFFFF wrap
+uint32_t ping_ticksToMillimeters(uint32_t pulseTicks);
+
 #endif /* PING_H_ */
@@ -0,0 +1,134 @@
+/**
+ * protocol.c
+ *
+ * Contains functions to send binary framed telemetry from the CyBot to the GUI client
+ * 
+ * @date November 22, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include "protocol.h"
+#include "uart.h"
+
+/* <----------| DEFINITIONS |----------> */
+
+#define PROTOCOL_MAX_FRAME (PROTOCOL_OVERHEAD + PROTOCOL_MAX_PAYLOAD)
+
+// Frames are double-buffered: one drains over uDMA while the next one is packed
+static uint8_t frames[2][PROTOCOL_MAX_FRAME];
+static volatile uint8_t frameBusy[2];
+static uint8_t nextFrame = 0;
+static uint8_t sequence = 0;
+
+// Waits for the next frame buffer to come back from uDMA, writes the header into it and returns a pointer to its payload
+static uint8_t *protocol_beginFrame(uint8_t type, uint16_t length);
+
+// Appends the CRC and hands the frame started by protocol_beginFrame() to uDMA
+static void protocol_finishFrame(uint16_t length);
+
+// uDMA completion callback that releases a frame buffer
+static void protocol_frameSent(const uint8_t *data, size_t length);
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+void protocol_sendFrame(uint8_t type, const uint8_t payload[], uint16_t length) {
+    uint8_t *output;
+    uint16_t i = 0;
+
+    if (length > PROTOCOL_MAX_PAYLOAD) {
+        return;
+    }
+
+    output = protocol_beginFrame(type, length);
+    for (i = 0; i < length; i++) {
+        output[i] = payload[i];
+    }
+
+    protocol_finishFrame(length);
+}
+
+void protocol_sendScan(const scanVector vectors[], uint8_t numVectors) {
+    uint16_t length = (uint16_t)numVectors * 3;
+    uint8_t *output;
+    uint8_t i = 0;
+
+    if (length > PROTOCOL_MAX_PAYLOAD) {
+        return;
+    }
+
+    output = protocol_beginFrame(PROTOCOL_MSG_SCAN, length);
+
+    // Fields are written one by one so the wire format doesn't depend on struct layout
+    for (i = 0; i < numVectors; i++) {
+        *output++ = vectors[i].angle;
+        *output++ = vectors[i].pingDistance;
+        *output++ = vectors[i].irDistance;
+    }
+
+    protocol_finishFrame(length);
+}
+
+void protocol_sendScanPoint(const scanVector *vector) {
+    uint8_t *output = protocol_beginFrame(PROTOCOL_MSG_SCAN_POINT, 3);
+
+    output[0] = vector->angle;
+    output[1] = vector->pingDistance;
+    output[2] = vector->irDistance;
+
+    protocol_finishFrame(3);
+}
+
+void protocol_sendScanEnd(uint8_t numVectors) {
+    protocol_sendFrame(PROTOCOL_MSG_SCAN_END, &numVectors, 1);
+}
+
+uint16_t protocol_crc16(uint16_t crc, const uint8_t data[], uint16_t length) {
+    uint16_t i = 0;
+
+    // Table-free byte-at-a-time form of the MSB-first 0x1021 polynomial
+    for (i = 0; i < length; i++) {
+        crc = (crc >> 8) | (crc << 8);
+        crc ^= data[i];
+        crc ^= (crc & 0xFF) >> 4;
+        crc ^= crc << 12;
+        crc ^= (crc & 0xFF) << 5;
+    }
+
+    return crc;
+}
+
+static uint8_t *protocol_beginFrame(uint8_t type, uint16_t length) {
+    uint8_t *frame = frames[nextFrame];
+
+    // Only blocks if this buffer is still draining from two frames ago
+    while (frameBusy[nextFrame]) {}
+
+    frame[0] = PROTOCOL_SYNC;
+    frame[1] = PROTOCOL_VERSION;
+    frame[2] = type;
+    frame[3] = sequence++;
+    frame[4] = length & 0xFF;
+    frame[5] = length >> 8;
+
+    return frame + PROTOCOL_HEADER_LEN;
+}
+
+static void protocol_finishFrame(uint16_t length) {
+    uint8_t *frame = frames[nextFrame];
+    uint16_t crc = protocol_crc16(0xFFFF, frame + 1, PROTOCOL_HEADER_LEN - 1 + length);
+
+    frame[PROTOCOL_HEADER_LEN + length] = crc & 0xFF;
+    frame[PROTOCOL_HEADER_LEN + length + 1] = crc >> 8;
+
+    frameBusy[nextFrame] = 1;
+    while (!uart_sendBufferAsync(frame, PROTOCOL_OVERHEAD + length, protocol_frameSent)) {}
+    nextFrame = !nextFrame;
+}
+
+static void protocol_frameSent(const uint8_t *data, size_t length) {
+    (void)length; // both frames are fixed buffers, which one finished is all that matters
+    frameBusy[data == frames[1]] = 0;
+}
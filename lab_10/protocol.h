@@ -0,0 +1,56 @@
+/**
+ * protocol.h
+ *
+ * Contains functions to send binary framed telemetry from the CyBot to the GUI client
+ *
+ * Frame layout (multi-byte fields little-endian):
+ *   [0]    PROTOCOL_SYNC
+ *   [1]    PROTOCOL_VERSION
+ *   [2]    message type
+ *   [3]    sequence number (wraps at 255)
+ *   [4..5] payload length
+ *   [6..]  payload
+ *   [end]  CRC16-CCITT (poly 0x1021, init 0xFFFF) over bytes 1 through the end of the payload
+ * 
+ * @date November 22, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+#ifndef PROTOCOL_H_
+#define PROTOCOL_H_
+
+#include <stdint.h>
+#include "scan.h"
+
+#define PROTOCOL_SYNC 0xA5
+#define PROTOCOL_VERSION 1
+
+// Bytes of framing around every payload (sync, version, type, sequence, length, CRC)
+#define PROTOCOL_HEADER_LEN 6
+#define PROTOCOL_OVERHEAD (PROTOCOL_HEADER_LEN + 2)
+
+// Largest payload a single frame can carry
+#define PROTOCOL_MAX_PAYLOAD 300
+
+// Message types
+#define PROTOCOL_MSG_SCAN 0x01       // Payload: one 3-byte record (angle, PING cm, IR cm) per scanned angle
+#define PROTOCOL_MSG_SCAN_POINT 0x02 // Payload: a single 3-byte record, sent as soon as it is measured
+#define PROTOCOL_MSG_SCAN_END 0x03   // Payload: 1 byte, number of PROTOCOL_MSG_SCAN_POINT frames in the sweep
+
+// Wraps payload in a frame and queues it for uDMA transmission. Waits only if both frame buffers are still draining
+void protocol_sendFrame(uint8_t type, const uint8_t payload[], uint16_t length);
+
+// Packs a whole scan into a single PROTOCOL_MSG_SCAN frame and sends it
+void protocol_sendScan(const scanVector vectors[], uint8_t numVectors);
+
+// Sends one measurement as a PROTOCOL_MSG_SCAN_POINT frame
+void protocol_sendScanPoint(const scanVector *vector);
+
+// Marks the end of a streamed sweep of numVectors points
+void protocol_sendScanEnd(uint8_t numVectors);
+
+// Returns the CRC16-CCITT of length bytes, continuing from crc (start with 0xFFFF)
+uint16_t protocol_crc16(uint16_t crc, const uint8_t data[], uint16_t length);
+
+#endif /* PROTOCOL_H_ */
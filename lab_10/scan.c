@@ -0,0 +1,252 @@
+/**
+ * scan.c
+ *
+ * Contains functions to sweep the servo and collect PING and IR distances across the field
+ * 
+ * @date November 22, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include <stdlib.h>
+#include "scan.h"
+#include "protocol.h"
+
+/* <----------| PRIVATE GLOBALS |----------> */
+
+// Trajectory followed by scanFieldContinuous()
+static float sweepStartAngle;
+static float sweepEndAngle;
+static uint32_t sweepStartMillis;
+static uint32_t sweepLastUpdateMillis;
+
+/* <----------| PRIVATE METHODS |----------> */
+
+// Advances the servo setpoint along the sweep trajectory, at most once per millisecond
+static void scan_updateSweep(void);
+
+// Fills the PING, IR and fused fields of vector from one IR reading and one finished PING
+static void scan_storeReadings(scanVector *vector, uint16_t irMM, ping_status_t pingStatus, uint32_t pulseTicks);
+
+// Returns true if an object edge lies somewhere between two coarse samples
+static bool scan_isEdge(const scanVector *first, const scanVector *second);
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+scanVector scanAngle(uint8_t angle) {
+    scanVector returnedVector;
+    ping_status_t pingStatus;
+    uint32_t pulseTicks = 0;
+    uint16_t irMM;
+
+    // Move servo to input angle and store in degrees, waiting only as long as this step needs to settle
+    servo_move((float)angle);
+    returnedVector.angle = angle;
+    returnedVector.timeMillis = 0;
+
+    // Fire the ultrasound first so the echo is in flight while the IR is sampled
+    ping_start();
+
+    // Scan converted IR data in millimeters
+    irMM = adc_calculateIRDistanceMM(adc_read());
+
+    // Collect ultrasound, then store both readings and their fused range
+    while ((pingStatus = ping_poll(&pulseTicks)) == PING_STATUS_BUSY) {}
+    scan_storeReadings(&returnedVector, irMM, pingStatus, pulseTicks);
+
+    return returnedVector;
+}
+
+void scanField(uint8_t startAngle, uint8_t endAngle, uint8_t incrementAngle, scanVector vectors[]) {
+    uint8_t index = 0;
+    uint8_t angle = startAngle;
+    uint32_t startMillis = timer_getMillis();
+
+    // Iterate through each angle in array (Chopped For loop)
+    while (angle <= endAngle) {
+        // Poll sensor and add value to array
+        vectors[index] = scanAngle(angle);
+        vectors[index].timeMillis = timer_getMillis() - startMillis;
+
+        index += 1;
+        angle += incrementAngle;
+    }
+}
+
+uint8_t scanFieldStreaming(uint8_t startAngle, uint8_t endAngle, uint8_t incrementAngle, scanVector vectors[]) {
+    uint8_t index = 0;
+    uint8_t angle = startAngle;
+
+    while (angle <= endAngle) {
+        vectors[index] = scanAngle(angle);
+
+        // Returns right away; the frame drains over uDMA while the servo settles on the next angle
+        protocol_sendScanPoint(&vectors[index]);
+
+        index += 1;
+        angle += incrementAngle;
+    }
+
+    protocol_sendScanEnd(index);
+
+    return index;
+}
+
+uint8_t scanFieldContinuous(uint8_t startAngle, uint8_t endAngle, uint8_t incrementAngle, scanVector vectors[]) {
+    uint8_t index = 0;
+    uint8_t angle = startAngle;
+    ping_status_t pingStatus;
+    uint32_t pulseTicks;
+    uint16_t irMM;
+    float captureAngle;
+
+    // Park at the start so the sweep begins from rest
+    servo_move((float)startAngle);
+
+    sweepStartAngle = startAngle;
+    sweepEndAngle = endAngle;
+    sweepStartMillis = timer_getMillis();
+    sweepLastUpdateMillis = sweepStartMillis - 1;
+
+    while (angle <= endAngle) {
+        // Keep the servo moving until it reaches this bin
+        do { scan_updateSweep(); } while (servo_getEstimatedAngle() < angle);
+
+        // Same ordering as scanAngle: echo in flight while the IR is read
+        captureAngle = servo_getEstimatedAngle();
+        pulseTicks = 0;
+        ping_start();
+        irMM = adc_calculateIRDistanceMM(adc_read());
+        vectors[index].timeMillis = timer_getMillis() - sweepStartMillis;
+
+        while ((pingStatus = ping_poll(&pulseTicks)) == PING_STATUS_BUSY) { scan_updateSweep(); }
+        scan_storeReadings(&vectors[index], irMM, pingStatus, pulseTicks);
+
+        // The ping covers the whole round trip, so tag the point with where the horn was halfway through it
+        captureAngle = (captureAngle + servo_getEstimatedAngle()) / 2;
+        vectors[index].angle = (uint8_t)(captureAngle + 0.5f);
+
+        index += 1;
+        angle += incrementAngle;
+    }
+
+    return index;
+}
+
+static void scan_updateSweep(void) {
+    uint32_t now = timer_getMillis();
+    float setpoint;
+
+    if (now == sweepLastUpdateMillis) { return; }
+    sweepLastUpdateMillis = now;
+
+    // Small, frequent setpoint steps keep the horn moving smoothly instead of jumping between bins
+    setpoint = sweepStartAngle + ((now - sweepStartMillis) * SCAN_SWEEP_DEG_PER_SEC) / 1000.0f;
+    if (setpoint > sweepEndAngle) { setpoint = sweepEndAngle; }
+
+    servo_moveAsync(setpoint);
+}
+
+uint8_t scanFieldAdaptive(uint8_t startAngle, uint8_t endAngle, uint8_t coarseIncrement, uint8_t fineIncrement, scanVector vectors[]) {
+    uint8_t last = (endAngle - startAngle) / fineIncrement;
+    uint8_t stride = coarseIncrement / fineIncrement;
+    uint8_t samples = 0;
+    uint8_t index = 0;
+    uint8_t previous;
+    uint8_t i;
+    uint32_t startMillis = timer_getMillis();
+
+    // Pass 1: coarse sweep forward, always finishing exactly on endAngle
+    while (1) {
+        vectors[index] = scanAngle(startAngle + index * fineIncrement);
+        vectors[index].timeMillis = timer_getMillis() - startMillis;
+        samples++;
+
+        if (index == last) { break; }
+        index = (last - index > stride) ? index + stride : last;
+    }
+
+    // Pass 2: walk back towards startAngle so the servo never has to return, refining only around edges
+    while (index > 0) {
+        previous = (index % stride) ? index - (index % stride) : index - stride;
+
+        if (scan_isEdge(&vectors[previous], &vectors[index])) {
+            for (i = index - 1; i > previous; i--) {
+                vectors[i] = scanAngle(startAngle + i * fineIncrement);
+                vectors[i].timeMillis = timer_getMillis() - startMillis;
+                samples++;
+            }
+        }
+        else {
+            for (i = index - 1; i > previous; i--) {
+                vectors[i] = (i - previous <= index - i) ? vectors[previous] : vectors[index];
+                vectors[i].angle = startAngle + i * fineIncrement;
+            }
+        }
+
+        index = previous;
+    }
+
+    return samples;
+}
+
+uint16_t scan_fuse(uint16_t irMM, bool irValid, uint16_t pingMM, bool pingValid, uint32_t *variance) {
+    uint32_t irSigma = SCAN_IR_SIGMA_BASE_MM + ((uint32_t)irMM * irMM) / SCAN_IR_SIGMA_DIVISOR;
+    uint32_t pingSigma = SCAN_PING_SIGMA_BASE_MM + pingMM / SCAN_PING_SIGMA_DIVISOR;
+    uint32_t irVariance = irSigma * irSigma;
+    uint32_t pingVariance = pingSigma * pingSigma;
+    uint32_t difference = irMM > pingMM ? irMM - pingMM : pingMM - irMM;
+
+    if (!irValid && !pingValid) {
+        *variance = SCAN_VARIANCE_UNKNOWN;
+        return PING_NO_ECHO_MM;
+    }
+    if (!pingValid) {
+        *variance = irVariance;
+        return irMM;
+    }
+    if (!irValid) {
+        *variance = pingVariance;
+        return pingMM;
+    }
+
+    // More than 3 sigma apart, the sensors are looking at different things: trust the quieter one, but say so
+    if (difference * difference > 9 * (irVariance + pingVariance)) {
+        *variance = (irVariance < pingVariance ? irVariance : pingVariance) + difference * difference / 4;
+        return irVariance < pingVariance ? irMM : pingMM;
+    }
+
+    // Inverse-variance weighting: d = (d_ir * v_ping + d_ping * v_ir) / (v_ir + v_ping), v = v_ir * v_ping / (v_ir + v_ping)
+    *variance = (irVariance * pingVariance) / (irVariance + pingVariance);
+    return (uint16_t)((((uint64_t)irMM * pingVariance + (uint64_t)pingMM * irVariance) + (irVariance + pingVariance) / 2) / (irVariance + pingVariance));
+}
+
+uint8_t isWithinTolerance(uint8_t value, uint8_t target, uint8_t tolerance) {
+    return abs(value - target) < tolerance;
+}
+
+static void scan_storeReadings(scanVector *vector, uint16_t irMM, ping_status_t pingStatus, uint32_t pulseTicks) {
+    uint32_t pingMM = pingStatus == PING_STATUS_DONE ? ping_ticksToMillimeters(pulseTicks) : PING_NO_ECHO_MM;
+    uint16_t irMaxMM = adc_getIRMaxMillimeters();
+
+    // Centimeter fields for the existing consumers (PING capped at 250cm, which is also what a missing echo reads as)
+    vector->irDistance = (irMM + 5) / 10;
+    vector->pingDistance = pingMM > 2500 ? (uint8_t)(250) : (uint8_t)((pingMM + 5) / 10);
+
+    // IR clamped at the end of its table saw nothing; PING past its no-echo distance is a timeout in disguise
+    vector->fusedDistance = scan_fuse(irMM, irMM < irMaxMM, pingMM > PING_NO_ECHO_MM ? PING_NO_ECHO_MM : pingMM,
+                                      pingStatus == PING_STATUS_DONE && pingMM < PING_NO_ECHO_MM, &vector->fusedVariance);
+}
+
+static bool scan_isEdge(const scanVector *first, const scanVector *second) {
+    bool firstInRange = first->fusedDistance < NO_OBJECT_DISTANCE * 10;
+    bool secondInRange = second->fusedDistance < NO_OBJECT_DISTANCE * 10;
+
+    // Centimeters, capped at NO_OBJECT_DISTANCE so a missing echo still fits isWithinTolerance()
+    uint8_t firstCM = firstInRange ? (first->fusedDistance + 5) / 10 : NO_OBJECT_DISTANCE;
+    uint8_t secondCM = secondInRange ? (second->fusedDistance + 5) / 10 : NO_OBJECT_DISTANCE;
+
+    return firstInRange != secondInRange || !isWithinTolerance(firstCM, secondCM, TOLERANCE);
+}
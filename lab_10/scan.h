@@ -0,0 +1,84 @@
+/**
+ * scan.h
+ *
+ * Contains the data types shared by the CyBot's field scanning code
+ * 
+ * @date November 22, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+#ifndef SCAN_H_
+#define SCAN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adc.h"
+#include "ping.h"
+#include "servo.h"
+
+// Servo setpoint speed for scanFieldContinuous(). Slow enough that a worst-case PING round trip
+// (~18 ms for an echo at 3 m) spans about 2 degrees, fast enough for a ~1.5 s half-circle
+#define SCAN_SWEEP_DEG_PER_SEC 120
+
+// Readings (cm) closer than this count as an object
+#define NO_OBJECT_DISTANCE 50
+
+// Neighbouring readings (cm) this far apart or more are treated as an edge
+#define TOLERANCE 3
+
+// Sensor noise models for scan_fuse(), standard deviations in mm.
+// IR: SCAN_IR_SIGMA_BASE_MM + d^2 / SCAN_IR_SIGMA_DIVISOR (2.5 mm at 10 cm, 14.5 mm at 50 cm, steep power law)
+// PING: SCAN_PING_SIGMA_BASE_MM + d / SCAN_PING_SIGMA_DIVISOR (15 mm at 50 cm, flat-ish out to 3 m)
+#define SCAN_IR_SIGMA_BASE_MM 2
+#define SCAN_IR_SIGMA_DIVISOR 20000
+#define SCAN_PING_SIGMA_BASE_MM 10
+#define SCAN_PING_SIGMA_DIVISOR 100
+
+// fusedVariance when neither sensor returned anything
+#define SCAN_VARIANCE_UNKNOWN UINT32_MAX
+
+// Wrapper struct for angle and distance values vector measured by the ultrasonic and IR sensors
+struct scanResultData {
+    uint8_t angle;
+    uint8_t pingDistance;
+    uint8_t irDistance;
+    uint16_t fusedDistance; // mm, IR and PING combined by scan_fuse()
+    uint32_t fusedVariance; // mm^2, SCAN_VARIANCE_UNKNOWN if neither sensor saw anything
+    uint16_t timeMillis; // When the sample was captured, ms since the scan started
+};
+
+// Prettier and faster way to type the way we're using our result data
+typedef struct scanResultData scanVector;
+
+// Points the servo at angle and returns the PING and IR distances measured there
+scanVector scanAngle(uint8_t angle);
+
+// Perform ultrasonic scan of field from startAngle to endAngle in incrementAngle increments, storing values in vectors array
+void scanField(uint8_t startAngle, uint8_t endAngle, uint8_t incrementAngle, scanVector vectors[]);
+
+// Same as scanField, but each point is framed and queued for uDMA as soon as it is measured so it drains
+// during the next servo move. Finishes with a PROTOCOL_MSG_SCAN_END frame. Returns the number of points
+uint8_t scanFieldStreaming(uint8_t startAngle, uint8_t endAngle, uint8_t incrementAngle, scanVector vectors[]);
+
+// Sweeps the servo smoothly from startAngle to endAngle without stopping, measuring on the fly. One sample
+// per incrementAngle bin, each tagged with the modelled servo angle at capture rather than the bin angle.
+// Several times faster than scanField at the cost of ~1 degree of angular accuracy. Returns the number of points
+uint8_t scanFieldContinuous(uint8_t startAngle, uint8_t endAngle, uint8_t incrementAngle, scanVector vectors[]);
+
+// Coarse-to-fine scan: sweeps at coarseIncrement, then walks back measuring every fineIncrement only inside
+// coarse intervals that contain an edge (fused ranges TOLERANCE or more apart, or one crosses NO_OBJECT_DISTANCE).
+// Fills vectors[] exactly like scanField at fineIncrement, so coarseIncrement must be a multiple of it.
+// Bins that were not measured copy the nearest coarse sample. Objects narrower than coarseIncrement can
+// fall between coarse samples and be missed. Returns the number of samples actually taken
+uint8_t scanFieldAdaptive(uint8_t startAngle, uint8_t endAngle, uint8_t coarseIncrement, uint8_t fineIncrement, scanVector vectors[]);
+
+// Combines one IR and one PING range (mm) into an inverse-variance weighted estimate, writing its variance (mm^2).
+// An invalid reading is ignored. If the two disagree by more than 3 sigma the less noisy one wins and the
+// variance grows by the disagreement, so a PING echo off a wide object next to an IR edge reads as uncertain
+uint16_t scan_fuse(uint16_t irMM, bool irValid, uint16_t pingMM, bool pingValid, uint32_t *variance);
+
+// Returns a 1 if given value is within +/- tolerance of target, 0 if not
+uint8_t isWithinTolerance(uint8_t value, uint8_t target, uint8_t tolerance);
+
+#endif /* SCAN_H_ */
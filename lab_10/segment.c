@@ -0,0 +1,114 @@
+/**
+ * segment.c
+ *
+ * Contains functions to split a field scan into a list of object descriptors
+ * 
+ * @date November 25, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include <stddef.h>
+#include "segment.h"
+#include "trig.h"
+
+/* <----------| DEFINES |----------> */
+
+#define SEGMENT_NO_OBJECT_MM (NO_OBJECT_DISTANCE * 10)
+
+/* <----------| PRIVATE TYPES |----------> */
+
+// Running state of the object currently being built
+typedef struct {
+    bool open;
+    uint8_t startIndex;
+    uint8_t lastIndex;    // Last in-range reading so far
+    uint8_t gap;          // Out-of-range readings since lastIndex
+    uint8_t numSamples;
+    uint8_t numConfident;
+} segment_run_t;
+
+/* <----------| PRIVATE METHODS |----------> */
+
+// Turns a finished run into a descriptor. Returns false if the run is too short to report
+static bool segment_closeRun(const scanVector vectors[], uint8_t numValues, const segment_run_t *run, segment_object_t *object);
+
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+uint8_t segment_findObjects(const scanVector vectors[], uint8_t numValues, segment_object_t objects[], uint8_t maxObjects, uint8_t *numDropped) {
+    segment_run_t run = { false, 0, 0, 0, 0, 0 };
+    segment_object_t found;
+    uint8_t numObjects = 0;
+    uint8_t dropped = 0;
+    uint8_t index;
+    uint16_t range;
+    uint16_t previousRange;
+    bool split;
+
+    // One extra iteration past the end closes an object still open at the last angle
+    for (index = 0; index <= numValues; index++) {
+        range = index < numValues ? vectors[index].fusedDistance : SEGMENT_NO_OBJECT_MM;
+
+        if (range < SEGMENT_NO_OBJECT_MM) {
+            // Same object if it continues close in depth to the last in-range reading, otherwise a new one
+            previousRange = vectors[run.lastIndex].fusedDistance;
+            split = run.open && (previousRange > range ? previousRange - range : range - previousRange) > SEGMENT_SPLIT_MM;
+
+            if (split) {
+                if (segment_closeRun(vectors, numValues, &run, &found)) {
+                    if (numObjects < maxObjects) { objects[numObjects++] = found; } else { dropped++; }
+                }
+                run.open = false;
+            }
+
+            if (!run.open) {
+                run.open = true;
+                run.startIndex = index;
+                run.numSamples = 0;
+                run.numConfident = 0;
+            }
+
+            run.lastIndex = index;
+            run.gap = 0;
+            run.numSamples++;
+            run.numConfident += vectors[index].fusedVariance <= SEGMENT_CONFIDENT_VARIANCE;
+        }
+        else if (run.open && (++run.gap > SEGMENT_MAX_GAP || index == numValues)) {
+            if (segment_closeRun(vectors, numValues, &run, &found)) {
+                if (numObjects < maxObjects) { objects[numObjects++] = found; } else { dropped++; }
+            }
+            run.open = false;
+        }
+    }
+
+    if (numDropped != NULL) { *numDropped = dropped; }
+
+    return numObjects;
+}
+
+uint16_t segment_chordMillimeters(uint16_t distanceMM, uint8_t startAngle, uint8_t endAngle) {
+    return trig_chord(distanceMM, endAngle - startAngle);
+}
+
+static bool segment_closeRun(const scanVector vectors[], uint8_t numValues, const segment_run_t *run, segment_object_t *object) {
+    uint8_t center;
+
+    if (run->numSamples < SEGMENT_MIN_SAMPLES) { return false; }
+
+    object->startAngle = vectors[run->startIndex].angle;
+    object->endAngle = vectors[run->lastIndex].angle;
+    object->centerAngle = ((uint16_t)object->startAngle + object->endAngle) / 2;
+    // A bridged dropout can land on the center, fall back to the first reading then
+    center = (run->startIndex + run->lastIndex) / 2;
+    if (vectors[center].fusedDistance >= SEGMENT_NO_OBJECT_MM) { center = run->startIndex; }
+    object->distanceMM = vectors[center].fusedDistance;
+    object->widthMM = segment_chordMillimeters(object->distanceMM, object->startAngle, object->endAngle);
+    object->numSamples = run->numSamples;
+    object->clipped = run->startIndex == 0 || run->lastIndex == numValues - 1;
+    object->confidence = (uint8_t)((100 * (uint16_t)run->numConfident) / run->numSamples) >> (object->clipped ? 1 : 0);
+
+    return true;
+}
@@ -0,0 +1,54 @@
+/**
+ * segment.h
+ *
+ * Contains functions to split a field scan into a list of object descriptors
+ *
+ * An object is a run of fused readings (scanVector.fusedDistance) closer than NO_OBJECT_DISTANCE. A jump of more than
+ * SEGMENT_SPLIT_MM between neighbouring in-range readings splits the run, so two objects touching in angle but at different depths come
+ * out separately. Short out-of-range dropouts inside a run are bridged, and runs shorter than
+ * SEGMENT_MIN_SAMPLES are discarded as noise.
+ * 
+ * @date November 25, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+#ifndef SEGMENT_H_
+#define SEGMENT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "scan.h"
+
+// Depth jump (mm) between neighbouring in-range fused readings that starts a new object
+#define SEGMENT_SPLIT_MM 80
+
+// Out-of-range readings in a row that are still treated as a dropout inside the same object
+#define SEGMENT_MAX_GAP 1
+
+// Fewest in-range readings an object needs to be reported
+#define SEGMENT_MIN_SAMPLES 2
+
+// Fused readings with a variance (mm^2) at or below this count as confident, 20 mm standard deviation
+#define SEGMENT_CONFIDENT_VARIANCE 400
+
+// One object found in a scan
+typedef struct {
+    uint8_t startAngle;   // First in-range reading
+    uint8_t endAngle;     // Last in-range reading
+    uint8_t centerAngle;  // Midpoint of start and end
+    uint16_t distanceMM;  // Fused distance to the object's center
+    uint16_t widthMM;     // Chord across the object at distanceMM
+    uint8_t confidence;   // 0-100, share of confident fused readings, halved if clipped
+    uint8_t numSamples;   // In-range readings in the object
+    bool clipped;         // Touches the first or last reading of the scan, so it may really be wider
+} segment_object_t;
+
+// Finds the objects in vectors[0..numValues-1] in one pass, writing at most maxObjects descriptors in angle order.
+// Returns how many were written. *numDropped (if not NULL) gets the number that did not fit
+uint8_t segment_findObjects(const scanVector vectors[], uint8_t numValues, segment_object_t objects[], uint8_t maxObjects, uint8_t *numDropped);
+
+// Linear width (mm) of something spanning startAngle..endAngle degrees at distanceMM, integer only (see trig_chord)
+uint16_t segment_chordMillimeters(uint16_t distanceMM, uint8_t startAngle, uint8_t endAngle);
+
+#endif /* SEGMENT_H_ */
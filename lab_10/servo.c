@@ -17,10 +17,36 @@
 /* <----------| DEFINES |----------> */
 
 #define BUTTON_DELAY_MICROS 500 // Magic value for faux "button debouncing" implemented in servo_callibrate()
-#define SERVO_DELAY_MILLIS 100
+#define SERVO_RANGE_DEGREES 180.0f
+#define SERVO_HISTORY_LEN 32 // Setpoints kept for servo_getEstimatedAngle(). Power of two, and more than the settle lag at 1 per ms
 
 volatile int button_num;
 
+/* <----------| PRIVATE GLOBALS |----------> */
+
+static uint16_t settleBaseMillis = SERVO_DEFAULT_SETTLE_BASE_MILLIS;
+static uint16_t settleMicrosPerDegree = SERVO_DEFAULT_MICROS_PER_DEGREE;
+static float commandedDegrees = -1.0f; // Negative until the first move, position unknown at power-up
+static uint32_t settleDeadlineMillis = 0;
+
+// One commanded move: the slew-limited path from fromDegrees to toDegrees, starting when it was commanded
+typedef struct {
+    uint32_t startMicros;
+    uint32_t travelMicros;
+    float fromDegrees;
+    float toDegrees;
+} servo_segment_t;
+
+// Recent moves, newest at newestSegment, so the path can be looked up a settle lag in the past
+static servo_segment_t segments[SERVO_HISTORY_LEN];
+static uint8_t newestSegment = 0;
+
+/* <----------| PRIVATE METHODS |----------> */
+
+// Where the slew-limited path through the commanded setpoints was at micros. Before the oldest remembered move
+// this is where that move started
+static float servo_pathAngle(uint32_t micros);
+
 /* <----------| IMPLEMENTATIONS |----------> */
 
 void servo_init(void) {
@@ -103,11 +129,99 @@ void servo_callibrate() {
 }
 
 void servo_move(float degrees) {
+    servo_moveAsync(degrees);
+    servo_waitSettled();
+}
+
+void servo_moveAsync(float degrees) {
     uint16_t requestedMatchValue = (int)(((servo_rightBound - servo_leftBound) * degrees) / 180 + servo_leftBound);
+    uint32_t nowMicros;
+    float fromDegrees;
+    float travel;
+    uint8_t i;
+
     TIMER1_TBMATCHR_R |= requestedMatchValue;
     TIMER1_TBMATCHR_R &= 0xFFFF0000 + requestedMatchValue;
 
-    timer_waitMillis(SERVO_DELAY_MILLIS);
+    // A move issued mid-swing starts from wherever the commanded path has got to. Nothing is known before the
+    // first move, so assume the horn is at the far end
+    nowMicros = timer_getMicros();
+    fromDegrees = commandedDegrees < 0 ? (degrees < SERVO_RANGE_DEGREES / 2 ? SERVO_RANGE_DEGREES : 0.0f) : servo_pathAngle(nowMicros);
+    travel = degrees > fromDegrees ? degrees - fromDegrees : fromDegrees - degrees;
+
+    newestSegment = (newestSegment + 1) & (SERVO_HISTORY_LEN - 1);
+    segments[newestSegment].startMicros = nowMicros;
+    segments[newestSegment].travelMicros = (uint32_t)(travel * settleMicrosPerDegree);
+    segments[newestSegment].fromDegrees = fromDegrees;
+    segments[newestSegment].toDegrees = degrees;
+
+    // First move: the whole history reads as the assumed starting point
+    if (commandedDegrees < 0) {
+        for (i = 0; i < SERVO_HISTORY_LEN; i++) {
+            segments[i] = segments[newestSegment];
+        }
+    }
+
+    commandedDegrees = degrees;
+    settleDeadlineMillis = timer_getMillis() + servo_settleMillis(travel);
+}
+
+float servo_getEstimatedAngle(void) {
+    if (commandedDegrees < 0) { return 0.0f; }
+
+    // The horn only starts following a setpoint the settle base later, so it trails the commanded path by that much
+    return servo_pathAngle(timer_getMicros() - settleBaseMillis * 1000);
+}
+
+bool servo_isSettled(void) {
+    // Signed difference so the comparison survives the millisecond counter wrapping
+    return (int32_t)(timer_getMillis() - settleDeadlineMillis) >= 0;
+}
+
+void servo_waitSettled(void) {
+    while (!servo_isSettled()) {}
+}
+
+void servo_setSlewModel(uint16_t baseMillis, uint16_t microsPerDegree) {
+    settleBaseMillis = baseMillis;
+    settleMicrosPerDegree = microsPerDegree;
+}
+
+uint16_t servo_settleMillis(float deltaDegrees) {
+    uint32_t travelMicros;
+
+    if (deltaDegrees < 0) { deltaDegrees = -deltaDegrees; }
+    if (deltaDegrees > SERVO_RANGE_DEGREES) { deltaDegrees = SERVO_RANGE_DEGREES; }
+
+    // Round the travel time up so short steps never get less than they need
+    travelMicros = (uint32_t)(deltaDegrees * settleMicrosPerDegree);
+    return settleBaseMillis + (uint16_t)((travelMicros + 999) / 1000);
+}
+
+static float servo_pathAngle(uint32_t micros) {
+    const servo_segment_t *segment = &segments[newestSegment];
+    uint32_t elapsed;
+    uint8_t age;
+
+    // Newest move that had started by then (signed difference survives the microsecond counter wrapping)
+    for (age = 0; age < SERVO_HISTORY_LEN; age++) {
+        segment = &segments[(newestSegment - age) & (SERVO_HISTORY_LEN - 1)];
+
+        if ((int32_t)(micros - segment->startMicros) >= 0) {
+            break;
+        }
+    }
+
+    if (age == SERVO_HISTORY_LEN) {
+        return segment->fromDegrees;
+    }
+
+    elapsed = micros - segment->startMicros;
+    if (elapsed >= segment->travelMicros) {
+        return segment->toDegrees;
+    }
+
+    return segment->fromDegrees + (segment->toDegrees - segment->fromDegrees) * ((float)elapsed / segment->travelMicros);
 }
 
 void servo_demo(void) {
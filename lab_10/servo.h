@@ -17,6 +17,10 @@
 #include "driverlib/interrupt.h"
 #include "Timer.h"
 
+// Default slew model, HS-311 class servo: ~0.19 s/60 deg at 4.8 V plus time for the horn to stop ringing
+#define SERVO_DEFAULT_SETTLE_BASE_MILLIS 15
+#define SERVO_DEFAULT_MICROS_PER_DEGREE 3200
+
 // TODO: settle on naming convention for library global variable names
 extern uint16_t servo_rightBound, servo_leftBound;
 
@@ -27,8 +31,28 @@ void servo_init(void);
 void servo_callibrate();
 
 // Sends out 5 us pulse and times length of pulse in to calculate distance from sensor in cm
+// Blocks only for as long as servo_settleMillis() says this particular move needs
 void servo_move(float degrees);
 
+// Starts moving the servo to degrees and returns right away, poll servo_isSettled() before measuring
+void servo_moveAsync(float degrees);
+
+// Returns true once the last servo_moveAsync() has had its full settle time
+bool servo_isSettled(void);
+
+// Where the slew model puts the horn right now: the slew-limited path through the commanded angles, followed
+// SERVO_DEFAULT_SETTLE_BASE_MILLIS (or servo_setSlewModel()'s baseMillis) late
+float servo_getEstimatedAngle(void);
+
+// Busy-waits until servo_isSettled()
+void servo_waitSettled(void);
+
+// Settle time model: baseMillis of fixed overhead plus microsPerDegree of travel (defaults below)
+void servo_setSlewModel(uint16_t baseMillis, uint16_t microsPerDegree);
+
+// Returns how long, in ms, the slew model says a move of deltaDegrees takes to settle
+uint16_t servo_settleMillis(float deltaDegrees);
+
 // Demo code for Lab 10 Part 2
 void servo_demo(void);
 
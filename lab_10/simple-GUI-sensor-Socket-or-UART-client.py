@@ -16,11 +16,26 @@ import tkinter as tk # Tkinter GUI library
 # Thread library: https://www.geeksforgeeks.org/how-to-use-thread-in-tkinter-python/
 import threading
 import os  # import function for finding absolute path to this python script
+import struct  # Unpacking binary frames sent by the Cybot
+import math  # Polar to canvas coordinates for the scan plot
 
 ##### START Define Functions  #########
 
 toggle_enabled = False
 
+# Binary frame format (must match protocol.h on the Cybot)
+FRAME_SYNC = 0xA5
+FRAME_VERSION = 1
+FRAME_HEADER_LEN = 6
+MSG_SCAN = 0x01
+MSG_SCAN_POINT = 0x02
+MSG_SCAN_END = 0x03
+
+# Scan plot geometry: bot sits at the bottom middle of the canvas, 0 degrees is to the right
+PLOT_WIDTH = 400
+PLOT_HEIGHT = 220
+PLOT_MAX_CM = 250
+
 # Main: Mostly used for setting up, and starting the GUI
 def main():
 
@@ -71,6 +86,11 @@ def main():
         scan_command_Button = tk.Button(text ="Press to Scan", command = send_scan)
         scan_command_Button.pack() # Pack the button into the window for display
 
+        # Polar plot of the latest scan, filled in point by point as the Cybot streams it
+        global scan_canvas  # Made global so Client function (socket_thread) can draw on it
+        scan_canvas = tk.Canvas(window, width=PLOT_WIDTH, height=PLOT_HEIGHT, bg="white")
+        scan_canvas.pack()
+
 
         # Create a Thread that will run a fuction assocated with a user defined "target" function.
         # In this case, the target function is the Client socket code
@@ -147,6 +167,69 @@ def send_autoContinue():
     
 
 
+# CRC16-CCITT (poly 0x1021, init 0xFFFF), same as protocol_crc16() on the Cybot
+def crc16(data):
+        crc = 0xFFFF
+        for byte in data:
+                crc ^= byte << 8
+                for _ in range(8):
+                        crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+        return crc
+
+
+# Read exactly n bytes (socket reads can come back short)
+def read_exact(cybot, n):
+        data = b""
+        while len(data) < n:
+                chunk = cybot.read(n - len(data))
+                if not chunk:
+                        raise ConnectionError("Cybot closed the connection")
+                data += chunk
+        return data
+
+
+# Wait for the next valid frame and return (message type, sequence number, payload bytes).
+# Stray bytes and frames with a bad version or CRC are skipped.
+def read_frame(cybot):
+        while True:
+                if read_exact(cybot, 1)[0] != FRAME_SYNC:
+                        continue
+
+                header = read_exact(cybot, FRAME_HEADER_LEN - 1)
+                version, msg_type, sequence, length = struct.unpack("<BBBH", header)
+                if version != FRAME_VERSION:
+                        print("Skipping frame with unknown version " + str(version))
+                        continue
+
+                payload = read_exact(cybot, length)
+                crc = struct.unpack("<H", read_exact(cybot, 2))[0]
+                if crc16(header + payload) != crc:
+                        print("Skipping frame with bad CRC (seq " + str(sequence) + ")")
+                        continue
+
+                return msg_type, sequence, payload
+
+
+# Split a MSG_SCAN payload into (angle, ping cm, IR cm) records
+def decode_scan(payload):
+        return [struct.unpack_from("<BBB", payload, i) for i in range(0, len(payload) - 2, 3)]
+
+
+# Wipe the scan plot before a new sweep
+def clear_plot():
+        scan_canvas.delete("all")
+
+
+# Draw one scan point: PING distance in blue, IR distance in red
+def plot_point(angle, ping_cm, ir_cm):
+        origin_x = PLOT_WIDTH / 2
+        origin_y = PLOT_HEIGHT - 10
+        scale = (PLOT_HEIGHT - 20) / PLOT_MAX_CM
+        for distance, color in ((ping_cm, "blue"), (ir_cm, "red")):
+                x = origin_x + distance * scale * math.cos(math.radians(angle))
+                y = origin_y - distance * scale * math.sin(math.radians(angle))
+                scan_canvas.create_oval(x - 2, y - 2, x + 2, y + 2, fill=color, outline=color)
+
 
 # Client socket code (Run by a thread created in main)
 def socket_thread():
@@ -192,18 +275,28 @@ def socket_thread():
                 Last_command_Label.config(text = command_display)  
         
                 # Check if a sensor scan command has been sent
-                if (send_message == "M\n") or (send_message == "m\n"):
+                if send_message in ("m", "M", "m\n", "M\n", "n", "N", "n\n", "N\n"):
 
                         print("Requested Sensor scan from Cybot:\n")
-                        rx_message = bytearray(1) # Initialize a byte array
-
                         # Create or overwrite existing sensor scan data file
                         file_object = open(full_path + filename,'w') # Open the file: file_object is just a variable for the file "handler" returned by open()
-
-                        while (rx_message.decode() != "END\n"): # Collect sensor data until "END" recieved
-                                rx_message = cybot.readline()   # Wait for sensor response, readline expects message to end with "\n"
-                                file_object.write(rx_message.decode())  # Write a line of sensor data to the file
-                                print(rx_message.decode()) # Convert message from bytes to String (i.e., decode), then print
+                        file_object.write("Angle(Degrees)\tSound_Dist(cm)\tIR_Dist(cm)\n")
+
+                        # Scan streams in as one frame per angle while the servo sweeps, then an END frame.
+                        # A whole-scan frame (MSG_SCAN) is handled too.
+                        clear_plot()
+                        msg_type, sequence, payload = read_frame(cybot)
+                        while msg_type != MSG_SCAN_END:
+                                if msg_type in (MSG_SCAN_POINT, MSG_SCAN):
+                                        for angle, ping_cm, ir_cm in decode_scan(payload):
+                                                row = str(angle) + "\t" + str(ping_cm) + "\t" + str(ir_cm)
+                                                file_object.write(row + "\n")  # Write a line of sensor data to the file
+                                                print(row)
+                                                plot_point(angle, ping_cm, ir_cm)
+
+                                if msg_type == MSG_SCAN:
+                                        break
+                                msg_type, sequence, payload = read_frame(cybot)
 
                         file_object.close() # Important to close file once you are done with it!!                
 
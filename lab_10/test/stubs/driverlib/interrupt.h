@@ -0,0 +1,24 @@
+/**
+ * interrupt.h (host test stand-in)
+ *
+ * TivaWare's interrupt API as the drivers use it, implemented by hw_stubs.c
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+#ifndef TEST_INTERRUPT_H_
+#define TEST_INTERRUPT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Records the handler so a test can see what was registered
+void IntRegister(uint32_t interrupt, void (*handler)(void));
+
+// Both return whether interrupts were already masked, like TivaWare
+bool IntMasterEnable(void);
+bool IntMasterDisable(void);
+
+#endif /* TEST_INTERRUPT_H_ */
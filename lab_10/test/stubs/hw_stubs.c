@@ -0,0 +1,451 @@
+/**
+ * hw_stubs.c
+ *
+ * Fake hardware and stand-ins for the drivers a module under test calls into. The driver stand-ins are weak, so
+ * linking the real driver alongside takes precedence. Nothing runs on its own: time moves through test_advance()
+ * (or code waiting on it), interrupts through test_interrupt() and uDMA through test_dmaRun()
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include <string.h>
+#include "hw_stubs.h"
+#include "adc.h"
+#include "dma.h"
+#include "ping.h"
+#include "protocol.h"
+#include "servo.h"
+#include "uart.h"
+
+/* <----------| DEFINES |----------> */
+
+#define TEST_WEAK __attribute__((weak))
+#define TEST_NUM_VECTORS 160
+
+// Set in every word the fake puts in a register it has to watch for writes (UART data, ADC overflow status). Code
+// never writes that bit, so a word without it means the driver wrote to the register since the fake last looked
+#define TEST_UNTOUCHED 0x80000000u
+
+typedef struct {
+    uint32_t rxQueue[TEST_UART_LOG_SIZE];  // Received bytes with their UARTDR error flags above bit 7
+    uint16_t rxHead;
+    uint16_t rxTail;
+    bool latched;                          // rxQueue[rxHead] is in the FIFO's read slot (RXFE clear)
+    bool offered;                          // data was last placed as the latched byte, so reading it consumed it
+    bool idle;
+    uint8_t txLog[TEST_UART_LOG_SIZE];
+    uint16_t txCount;
+    uint8_t txFifo;
+    bool holdTx;
+    volatile uint32_t data;
+    volatile uint32_t flags;
+    volatile uint32_t maskedStatus;
+} test_uart_t;
+
+/* <----------| PRIVATE GLOBALS |----------> */
+
+volatile uint32_t test_registers[TEST_NUM_REGISTERS];
+
+uint32_t test_micros = 0;
+uint32_t test_clockStep = 0;
+void (*test_onAdvance)(void) = NULL;
+
+test_dmaChannel_t test_dma[32];
+bool test_dmaAutoComplete = false;
+
+uint16_t (*test_adcInput)(void) = NULL;
+
+static void (*handlers[TEST_NUM_VECTORS])(void);
+static bool interruptsMasked = false;
+
+static test_uart_t uarts[TEST_NUM_UARTS] = {
+    [TEST_UART1].data = TEST_UNTOUCHED,
+    [TEST_UART4].data = TEST_UNTOUCHED,
+};
+static volatile uint32_t adcFifos[4];
+static uint32_t adcOverflows = 0;
+static volatile uint32_t adcOverflowRegister = TEST_UNTOUCHED;
+
+/* <----------| CLOCK |----------> */
+
+void test_advance(uint32_t micros) {
+    test_micros += micros;
+
+    if (test_onAdvance) {
+        test_onAdvance();
+    }
+}
+
+// Timer.h
+TEST_WEAK void timer_init(void) {}
+
+TEST_WEAK unsigned int timer_getMillis(void) {
+    test_advance(test_clockStep);
+    return test_micros / 1000;
+}
+
+TEST_WEAK unsigned int timer_getMicros(void) {
+    test_advance(test_clockStep);
+    return test_micros;
+}
+
+TEST_WEAK void timer_waitMillis(unsigned int delay_time) { test_advance(delay_time * 1000); }
+TEST_WEAK void timer_waitMicros(unsigned int delay_time) { test_advance(delay_time); }
+
+/* <----------| INTERRUPTS |----------> */
+
+bool test_interrupt(uint32_t interrupt) {
+    if (interrupt >= TEST_NUM_VECTORS || !handlers[interrupt] || interruptsMasked) {
+        return false;
+    }
+
+    handlers[interrupt]();
+    return true;
+}
+
+bool test_interruptsMasked(void) {
+    return interruptsMasked;
+}
+
+// driverlib/interrupt.h
+TEST_WEAK void IntRegister(uint32_t interrupt, void (*handler)(void)) {
+    if (interrupt < TEST_NUM_VECTORS) {
+        handlers[interrupt] = handler;
+    }
+}
+
+TEST_WEAK bool IntMasterEnable(void) {
+    bool wasMasked = interruptsMasked;
+    interruptsMasked = false;
+    return wasMasked;
+}
+
+TEST_WEAK bool IntMasterDisable(void) {
+    bool wasMasked = interruptsMasked;
+    interruptsMasked = true;
+    return wasMasked;
+}
+
+/* <----------| UART |----------> */
+
+// Catches up with whatever the driver did to the data register since the fake last handed it out
+static void test_uartSync(test_uart_t *uart) {
+    if (!(uart->data & TEST_UNTOUCHED)) {
+        uart->txLog[uart->txCount++ % TEST_UART_LOG_SIZE] = (uint8_t)uart->data;
+
+        if (uart->holdTx) {
+            uart->txFifo++;
+        }
+    }
+    else if (uart->offered) {
+        uart->latched = false;
+        uart->rxHead++;
+    }
+
+    uart->offered = false;
+    uart->data = TEST_UNTOUCHED;
+}
+
+static uint16_t test_uartReceiveLevel(test_uart_t *uart) {
+    return (uint16_t)(uart->rxTail - uart->rxHead);
+}
+
+static bool test_uartTxFull(test_uart_t *uart) {
+    return uart->holdTx && uart->txFifo >= TEST_UART_FIFO_DEPTH;
+}
+
+volatile uint32_t *test_uartData(test_uartPort_t port) {
+    test_uart_t *uart = &uarts[port];
+
+    test_uartSync(uart);
+
+    if (uart->latched) {
+        uart->data = TEST_UNTOUCHED | uart->rxQueue[uart->rxHead % TEST_UART_LOG_SIZE];
+        uart->offered = true;
+    }
+
+    return &uart->data;
+}
+
+volatile uint32_t *test_uartFlags(test_uartPort_t port) {
+    test_uart_t *uart = &uarts[port];
+
+    test_uartSync(uart);
+
+    if (!uart->latched && test_uartReceiveLevel(uart)) {
+        uart->latched = true;
+    }
+
+    uart->flags = (uart->latched ? 0 : UART_FR_RXFE) | (test_uartTxFull(uart) ? UART_FR_TXFF : 0);
+    return &uart->flags;
+}
+
+volatile uint32_t *test_uartMaskedStatus(test_uartPort_t port) {
+    test_uart_t *uart = &uarts[port];
+    volatile uint32_t *mask = port == TEST_UART1 ? &UART1_IM_R : &UART4_IM_R;
+    uint32_t raw = 0;
+
+    test_uartSync(uart);
+
+    // Same thresholds uart.c programs into UART1_IFLS_R (and the reset ones UART4 keeps): RX at 1/2, TX at 1/8
+    if (test_uartReceiveLevel(uart) >= TEST_UART_FIFO_DEPTH / 2) { raw |= UART_MIS_RXMIS; }
+    if (uart->idle && test_uartReceiveLevel(uart)) { raw |= UART_MIS_RTMIS; }
+    if (uart->txFifo <= TEST_UART_FIFO_DEPTH / 8) { raw |= UART_MIS_TXMIS; }
+
+    uart->maskedStatus = raw & *mask;
+    return &uart->maskedStatus;
+}
+
+// Finds the fake UART whose data register the uDMA fake is writing to, if any
+static test_uart_t *test_uartAt(volatile void *address) {
+    uint8_t port;
+
+    for (port = 0; port < TEST_NUM_UARTS; port++) {
+        if (address == &uarts[port].data) {
+            return &uarts[port];
+        }
+    }
+
+    return NULL;
+}
+
+void test_uartQueue(test_uartPort_t port, const uint8_t data[], uint16_t length) {
+    uint16_t i;
+
+    for (i = 0; i < length; i++) {
+        test_uartQueueWithFlags(port, data[i], 0);
+    }
+}
+
+void test_uartQueueWithFlags(test_uartPort_t port, uint8_t data, uint32_t flags) {
+    test_uart_t *uart = &uarts[port];
+
+    test_uartSync(uart);
+    uart->rxQueue[uart->rxTail++ % TEST_UART_LOG_SIZE] = data | flags;
+    uart->idle = false;
+}
+
+void test_uartIdle(test_uartPort_t port) {
+    test_uartSync(&uarts[port]);
+    uarts[port].idle = true;
+}
+
+uint16_t test_uartPending(test_uartPort_t port) {
+    test_uartSync(&uarts[port]);
+    return test_uartReceiveLevel(&uarts[port]);
+}
+
+uint16_t test_uartSent(test_uartPort_t port, uint8_t out[], uint16_t max) {
+    test_uart_t *uart = &uarts[port];
+    uint16_t count;
+
+    test_uartSync(uart);
+    count = uart->txCount < max ? uart->txCount : max;
+    memcpy(out, uart->txLog, count);
+    uart->txCount = 0;
+
+    return count;
+}
+
+void test_uartHoldTx(test_uartPort_t port, bool hold) {
+    test_uartSync(&uarts[port]);
+    uarts[port].holdTx = hold;
+
+    if (!hold) {
+        uarts[port].txFifo = 0;
+    }
+}
+
+uint8_t test_uartShiftOut(test_uartPort_t port, uint8_t count) {
+    test_uart_t *uart = &uarts[port];
+
+    test_uartSync(uart);
+    count = count < uart->txFifo ? count : uart->txFifo;
+    uart->txFifo -= count;
+
+    return count;
+}
+
+uint8_t test_uartTxLevel(test_uartPort_t port) {
+    test_uartSync(&uarts[port]);
+    return uarts[port].txFifo;
+}
+
+/* <----------| ADC |----------> */
+
+// One FIFO entry: the hardware averager's 1 << SAC conversions, 1 us each
+static void test_adcConvert(uint8_t sequencer) {
+    uint32_t conversions = 1u << (ADC0_SAC_R & 0x7);
+    uint32_t sum = 0;
+    uint32_t i;
+
+    for (i = 0; i < conversions; i++) {
+        sum += test_adcInput ? test_adcInput() : 0;
+        test_advance(1);
+    }
+
+    adcFifos[sequencer] = sum / conversions;
+}
+
+volatile uint32_t *test_adcFifo(uint8_t sequencer) {
+    test_adcConvert(sequencer);
+    return &adcFifos[sequencer];
+}
+
+volatile uint32_t *test_adcOverflowStatus(void) {
+    if (!(adcOverflowRegister & TEST_UNTOUCHED)) {
+        adcOverflows &= ~adcOverflowRegister;
+    }
+
+    adcOverflowRegister = TEST_UNTOUCHED | adcOverflows;
+    return &adcOverflowRegister;
+}
+
+void test_adcOverflow(uint32_t sequencers) {
+    test_adcOverflowStatus();
+    adcOverflows |= sequencers;
+    adcOverflowRegister = TEST_UNTOUCHED | adcOverflows;
+}
+
+/* <----------| uDMA |----------> */
+
+// Converts a UDMA_CHCTL_*INC_* field (0 = byte, 1 = half-word, 2 = word, 3 = none) into a pointer step
+static uint8_t test_dmaIncrement(uint32_t field) {
+    return field == 3 ? 0 : (uint8_t)(1u << field);
+}
+
+uint16_t test_dmaRun(uint8_t channel, uint16_t count) {
+    test_dmaChannel_t *dma = &test_dma[channel];
+    uint16_t moved = 0;
+
+    while (moved < count && dma->enabled) {
+        test_dmaDescriptor_t *descriptor = dma->useAlternate ? &dma->alternate : &dma->primary;
+        uint8_t sourceSize = (uint8_t)(1u << ((descriptor->control >> 24) & 0x3));
+        uint8_t destinationSize = (uint8_t)(1u << ((descriptor->control >> 28) & 0x3));
+        test_uart_t *uart = test_uartAt(descriptor->destination);
+        uint32_t item = 0;
+        uint8_t sequencer;
+
+        // A full TX FIFO holds off the UART's request
+        if (uart && test_uartTxFull(uart)) {
+            break;
+        }
+
+        for (sequencer = 0; sequencer < 4; sequencer++) {
+            if (descriptor->source == &adcFifos[sequencer]) {
+                test_adcConvert(sequencer);
+            }
+        }
+
+        memcpy(&item, (const void *)descriptor->source, sourceSize);
+
+        // A byte written to a data register is the whole write as far as the fake UART is concerned
+        if (uart) {
+            uart->data = item;
+            test_uartSync(uart);
+        }
+        else {
+            memcpy((void *)descriptor->destination, &item, destinationSize);
+        }
+
+        descriptor->source = (volatile uint8_t *)descriptor->source + test_dmaIncrement((descriptor->control >> 26) & 0x3);
+        descriptor->destination = (volatile uint8_t *)descriptor->destination + test_dmaIncrement((descriptor->control >> 30) & 0x3);
+        descriptor->remaining--;
+        dma->transfers++;
+        moved++;
+
+        if (descriptor->remaining) {
+            continue;
+        }
+
+        // Descriptor done: basic mode disarms, ping-pong moves to the other half unless it was left stopped
+        dma->completed = true;
+
+        if ((descriptor->control & UDMA_CHCTL_XFERMODE_M) == UDMA_CHCTL_XFERMODE_PINGPONG) {
+            dma->useAlternate = !dma->useAlternate;
+            dma->enabled = (dma->useAlternate ? dma->alternate : dma->primary).remaining != 0;
+        }
+        else {
+            dma->enabled = false;
+        }
+    }
+
+    return moved;
+}
+
+// dma.h
+TEST_WEAK void dma_init(void) {}
+
+TEST_WEAK void dma_configureChannel(uint8_t channel, uint8_t encoding) {
+    memset(&test_dma[channel], 0, sizeof(test_dma[channel]));
+    test_dma[channel].encoding = encoding;
+}
+
+TEST_WEAK void dma_setTransfer(uint8_t channel, bool alternate, volatile void *source, volatile void *destination, uint32_t control, uint16_t count) {
+    test_dmaDescriptor_t *descriptor = alternate ? &test_dma[channel].alternate : &test_dma[channel].primary;
+
+    descriptor->source = source;
+    descriptor->destination = destination;
+    descriptor->control = control;
+    descriptor->remaining = count;
+}
+
+TEST_WEAK void dma_enableChannel(uint8_t channel) {
+    test_dma[channel].enabled = true;
+
+    if (test_dmaAutoComplete && (test_dma[channel].primary.control & UDMA_CHCTL_XFERMODE_M) == UDMA_CHCTL_XFERMODE_BASIC) {
+        test_dmaRun(channel, test_dma[channel].primary.remaining);
+    }
+}
+
+TEST_WEAK bool dma_isChannelEnabled(uint8_t channel) { return test_dma[channel].enabled; }
+
+TEST_WEAK bool dma_isTransferDone(uint8_t channel, bool alternate) {
+    return (alternate ? test_dma[channel].alternate : test_dma[channel].primary).remaining == 0;
+}
+
+TEST_WEAK uint16_t dma_getRemaining(uint8_t channel, bool alternate) {
+    return (alternate ? test_dma[channel].alternate : test_dma[channel].primary).remaining;
+}
+
+TEST_WEAK bool dma_isAlternateActive(uint8_t channel) { return test_dma[channel].useAlternate; }
+TEST_WEAK void dma_disableChannel(uint8_t channel) { test_dma[channel].enabled = false; }
+TEST_WEAK void dma_clearInterrupt(uint8_t channel) { test_dma[channel].completed = false; }
+
+/* <----------| DRIVER STAND-INS |----------> */
+
+// lcd.h (not included: its inline declarations have no definitions on the host)
+TEST_WEAK void lcd_printf(const char *format, ...) {}
+
+// adc.h
+TEST_WEAK uint16_t adc_read(void) { return 0; }
+TEST_WEAK uint16_t adc_calculateIRDistanceMM(uint16_t adcCode) { return 0; }
+TEST_WEAK uint16_t adc_getIRMaxMillimeters(void) { return 500; }
+
+// ping.h: every ping times out
+TEST_WEAK void ping_start(void) {}
+TEST_WEAK ping_status_t ping_poll(uint32_t *pulseTicks) { *pulseTicks = 0; return PING_STATUS_NO_ECHO; }
+TEST_WEAK uint32_t ping_ticksToMillimeters(uint32_t pulseTicks) { return PING_NO_ECHO_MM; }
+
+// servo.h: moves are instant
+static float servoAngle = 0.0f;
+TEST_WEAK void servo_move(float degrees) { servoAngle = degrees; }
+TEST_WEAK void servo_moveAsync(float degrees) { servoAngle = degrees; }
+TEST_WEAK float servo_getEstimatedAngle(void) { return servoAngle; }
+
+// protocol.h
+TEST_WEAK void protocol_sendScanPoint(const scanVector *vector) {}
+TEST_WEAK void protocol_sendScanEnd(uint8_t numVectors) {}
+
+// uart.h: async buffers complete immediately
+TEST_WEAK void uart_sendChar(char data) {}
+TEST_WEAK void uart_sendStr(const char *data) {}
+
+TEST_WEAK bool uart_sendBufferAsync(const uint8_t *data, size_t length, uart_txCallback_t callback) {
+    if (callback) { callback(data, length); }
+    return true;
+}
@@ -0,0 +1,112 @@
+/**
+ * hw_stubs.h
+ *
+ * Controls for the fake hardware in hw_stubs.c: a microsecond clock, the interrupt table, UART1 and UART4, a uDMA
+ * controller that moves data when a test tells it to, and the ADC's analog input
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+#ifndef HW_STUBS_H_
+#define HW_STUBS_H_
+
+#include <inc/tm4c123gh6pm.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "driverlib/interrupt.h"
+
+/* <----------| CLOCK |----------> */
+
+// What timer_getMicros() returns (timer_getMillis() is this / 1000). Only moves through test_advance()
+extern uint32_t test_micros;
+
+// Added to the clock on every timer_get*() call, so code that spins on the clock sees time pass (0 = frozen)
+extern uint32_t test_clockStep;
+
+// Called after every change of test_micros, for tests that simulate hardware moving in real time
+extern void (*test_onAdvance)(void);
+
+// Moves the clock forward
+void test_advance(uint32_t micros);
+
+/* <----------| INTERRUPTS |----------> */
+
+// Runs the handler IntRegister() bound to a vector. Returns false if there is none
+bool test_interrupt(uint32_t interrupt);
+
+// True between IntMasterDisable() and IntMasterEnable()
+bool test_interruptsMasked(void);
+
+/* <----------| UART |----------> */
+
+// Bytes the fake UARTs hold per direction before they wrap (tests never get close)
+#define TEST_UART_LOG_SIZE 8192
+
+// Depth of the hardware FIFOs
+#define TEST_UART_FIFO_DEPTH 16
+
+// Queues bytes for a UART to receive, in order. The line counts as busy until test_uartIdle()
+void test_uartQueue(test_uartPort_t port, const uint8_t data[], uint16_t length);
+
+// Queues one byte carrying UART_DR_* error flags
+void test_uartQueueWithFlags(test_uartPort_t port, uint8_t data, uint32_t flags);
+
+// Marks the receive line idle, which raises the receive timeout while bytes wait in the FIFO
+void test_uartIdle(test_uartPort_t port);
+
+// Bytes queued but not yet read
+uint16_t test_uartPending(test_uartPort_t port);
+
+// Copies out (up to max) and forgets the bytes written to the data register since the last call
+uint16_t test_uartSent(test_uartPort_t port, uint8_t out[], uint16_t max);
+
+// While held, written bytes stay in the TX FIFO (TXFF once it holds TEST_UART_FIFO_DEPTH) until test_uartShiftOut()
+void test_uartHoldTx(test_uartPort_t port, bool hold);
+
+// Lets up to count bytes leave the held TX FIFO. Returns how many did
+uint8_t test_uartShiftOut(test_uartPort_t port, uint8_t count);
+
+// Bytes sitting in the TX FIFO
+uint8_t test_uartTxLevel(test_uartPort_t port);
+
+/* <----------| uDMA |----------> */
+
+typedef struct {
+    volatile void *source;
+    volatile void *destination;
+    uint32_t control;
+    uint16_t remaining;
+} test_dmaDescriptor_t;
+
+typedef struct {
+    test_dmaDescriptor_t primary;
+    test_dmaDescriptor_t alternate;
+    uint8_t encoding;
+    bool enabled;
+    bool useAlternate;
+    bool completed;      // UDMACHIS bit: set when a descriptor finishes, cleared by dma_clearInterrupt()
+    uint32_t transfers;  // Items moved since the test started
+} test_dmaChannel_t;
+
+// Every channel the dma.h stand-in knows about
+extern test_dmaChannel_t test_dma[32];
+
+// When set, arming a basic-mode channel runs it to completion right away, as if the peripheral took every byte
+extern bool test_dmaAutoComplete;
+
+// Services up to count requests on a channel, following ping-pong hand-offs. Returns how many items moved
+uint16_t test_dmaRun(uint8_t channel, uint16_t count);
+
+/* <----------| ADC |----------> */
+
+// Produces one raw 12-bit conversion. The fake ADC averages 1 << ADC0_SAC_R of them per FIFO entry and takes
+// 1 us per conversion, like the real one at 1 Msps. NULL reads as 0
+extern uint16_t (*test_adcInput)(void);
+
+// Sets sequencer overflow bits in ADC0_OSTAT_R, as when a FIFO fills before anything reads it
+void test_adcOverflow(uint32_t sequencers);
+
+#endif /* HW_STUBS_H_ */
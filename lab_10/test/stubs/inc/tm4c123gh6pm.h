@@ -0,0 +1,186 @@
+/**
+ * tm4c123gh6pm.h (host test stand-in)
+ *
+ * Just enough of TI's register header to build the CyBot drivers on a PC. Most registers are plain words in
+ * test_registers[]. The ones whose accesses have side effects on hardware (UART data, flag and masked interrupt
+ * status, the ADC sequencer FIFOs and overflow status) are backed by the fakes in hw_stubs.c. Constants carry their
+ * datasheet values.
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+#ifndef TEST_TM4C123GH6PM_H_
+#define TEST_TM4C123GH6PM_H_
+
+#include <stdint.h>
+
+/* <----------| FAKE PERIPHERALS |----------> */
+
+typedef enum {
+    TEST_UART1,
+    TEST_UART4,
+    TEST_NUM_UARTS
+} test_uartPort_t;
+
+// Reading UARTn_FR_R moves the next byte queued with test_uartQueue() into UARTn_DR_R and clears RXFE, and the
+// next access to UARTn_DR_R takes it. Writes to UARTn_DR_R are logged for test_uartSent(). As on hardware, code
+// has to check RXFE before reading. UARTn_MIS_R is computed from the fake FIFO levels and UARTn_IM_R
+volatile uint32_t *test_uartData(test_uartPort_t port);
+volatile uint32_t *test_uartFlags(test_uartPort_t port);
+volatile uint32_t *test_uartMaskedStatus(test_uartPort_t port);
+
+// Every read converts a fresh sample through the fake ADC input (see test_adcInput in hw_stubs.h)
+volatile uint32_t *test_adcFifo(uint8_t sequencer);
+
+// Overflow status is write-1-to-clear, as on hardware. Set bits with test_adcOverflow() in hw_stubs.h
+volatile uint32_t *test_adcOverflowStatus(void);
+
+/* <----------| REGISTERS |----------> */
+
+#define TEST_NUM_REGISTERS 80
+
+extern volatile uint32_t test_registers[TEST_NUM_REGISTERS];
+
+#define UART1_DR_R               (*test_uartData(TEST_UART1))
+#define UART1_FR_R               (*test_uartFlags(TEST_UART1))
+#define UART1_MIS_R              (*test_uartMaskedStatus(TEST_UART1))
+#define UART4_DR_R               (*test_uartData(TEST_UART4))
+#define UART4_FR_R               (*test_uartFlags(TEST_UART4))
+#define UART4_MIS_R              (*test_uartMaskedStatus(TEST_UART4))
+#define ADC0_SSFIFO0_R           (*test_adcFifo(0))
+#define ADC0_SSFIFO3_R           (*test_adcFifo(3))
+#define ADC0_OSTAT_R             (*test_adcOverflowStatus())
+
+#define ADC0_ACTSS_R             (test_registers[0])
+#define ADC0_EMUX_R              (test_registers[1])
+#define ADC0_IM_R                (test_registers[2])
+#define ADC0_ISC_R               (test_registers[3])
+#define ADC0_PSSI_R              (test_registers[4])
+#define ADC0_RIS_R               (test_registers[5])
+#define ADC0_SAC_R               (test_registers[6])
+#define ADC0_SSCTL0_R            (test_registers[7])
+#define ADC0_SSCTL3_R            (test_registers[8])
+#define ADC0_SSMUX0_R            (test_registers[9])
+#define ADC0_SSMUX3_R            (test_registers[10])
+#define ADC0_SSPRI_R             (test_registers[11])
+#define GPIO_PORTB_AFSEL_R       (test_registers[12])
+#define GPIO_PORTB_AMSEL_R       (test_registers[13])
+#define GPIO_PORTB_DATA_R        (test_registers[14])
+#define GPIO_PORTB_DEN_R         (test_registers[15])
+#define GPIO_PORTB_DIR_R         (test_registers[16])
+#define GPIO_PORTB_PCTL_R        (test_registers[17])
+#define GPIO_PORTC_AFSEL_R       (test_registers[18])
+#define GPIO_PORTC_DEN_R         (test_registers[19])
+#define GPIO_PORTC_DIR_R         (test_registers[20])
+#define GPIO_PORTC_PCTL_R        (test_registers[21])
+#define GPIO_PORTF_CR_R          (test_registers[22])
+#define GPIO_PORTF_DEN_R         (test_registers[23])
+#define GPIO_PORTF_DIR_R         (test_registers[24])
+#define GPIO_PORTF_IBE_R         (test_registers[25])
+#define GPIO_PORTF_ICR_R         (test_registers[26])
+#define GPIO_PORTF_IEV_R         (test_registers[27])
+#define GPIO_PORTF_IM_R          (test_registers[28])
+#define GPIO_PORTF_LOCK_R        (test_registers[29])
+#define GPIO_PORTF_RIS_R         (test_registers[30])
+#define NVIC_DIS1_R              (test_registers[31])
+#define NVIC_EN0_R               (test_registers[32])
+#define NVIC_EN1_R               (test_registers[33])
+#define SYSCTL_PRTIMER_R         (test_registers[34])
+#define SYSCTL_RCGCADC_R         (test_registers[35])
+#define SYSCTL_RCGCGPIO_R        (test_registers[36])
+#define SYSCTL_RCGCTIMER_R       (test_registers[37])
+#define SYSCTL_RCGCUART_R        (test_registers[38])
+#define TIMER1_CFG_R             (test_registers[39])
+#define TIMER1_CTL_R             (test_registers[40])
+#define TIMER1_TBILR_R           (test_registers[41])
+#define TIMER1_TBMATCHR_R        (test_registers[42])
+#define TIMER1_TBMR_R            (test_registers[43])
+#define TIMER1_TBPMR_R           (test_registers[44])
+#define TIMER1_TBPR_R            (test_registers[45])
+#define TIMER2_CFG_R             (test_registers[46])
+#define TIMER2_CTL_R             (test_registers[47])
+#define TIMER2_TAILR_R           (test_registers[48])
+#define TIMER2_TAMR_R            (test_registers[49])
+#define TIMER3_CFG_R             (test_registers[50])
+#define TIMER3_CTL_R             (test_registers[51])
+#define TIMER3_ICR_R             (test_registers[52])
+#define TIMER3_IMR_R             (test_registers[53])
+#define TIMER3_MIS_R             (test_registers[54])
+#define TIMER3_TAILR_R           (test_registers[55])
+#define TIMER3_TAMR_R            (test_registers[56])
+#define TIMER3_TAPR_R            (test_registers[57])
+#define TIMER3_TBILR_R           (test_registers[58])
+#define TIMER3_TBMR_R            (test_registers[59])
+#define TIMER3_TBPR_R            (test_registers[60])
+#define TIMER3_TBR_R             (test_registers[61])
+#define UART1_CC_R               (test_registers[62])
+#define UART1_CTL_R              (test_registers[63])
+#define UART1_DMACTL_R           (test_registers[64])
+#define UART1_FBRD_R             (test_registers[65])
+#define UART1_IBRD_R             (test_registers[66])
+#define UART1_ICR_R              (test_registers[67])
+#define UART1_IFLS_R             (test_registers[68])
+#define UART1_IM_R               (test_registers[69])
+#define UART1_LCRH_R             (test_registers[70])
+#define UART4_CC_R               (test_registers[71])
+#define UART4_CTL_R              (test_registers[72])
+#define UART4_DMACTL_R           (test_registers[73])
+#define UART4_ECR_R              (test_registers[74])
+#define UART4_FBRD_R             (test_registers[75])
+#define UART4_IBRD_R             (test_registers[76])
+#define UART4_ICR_R              (test_registers[77])
+#define UART4_IM_R               (test_registers[78])
+#define UART4_LCRH_R             (test_registers[79])
+
+/* <----------| CONSTANTS |----------> */
+
+#define INT_UART1                      22
+#define INT_ADC0SS3                    33
+#define INT_GPIOF                      46
+#define INT_TIMER3A                    51
+#define INT_TIMER3B                    52
+#define INT_UART4                      76
+#define SYSCTL_RCGCGPIO_R2             0x00000004
+#define SYSCTL_RCGCGPIO_R5             0x00000020
+#define SYSCTL_RCGCUART_R4             0x00000010
+#define UART_CC_CS_SYSCLK              0x00000000
+#define UART_CTL_RXE                   0x00000200
+#define UART_CTL_TXE                   0x00000100
+#define UART_CTL_UARTEN                0x00000001
+#define UART_DMACTL_TXDMAE             0x00000002
+#define UART_DR_OE                     0x00000800
+#define UART_DR_BE                     0x00000400
+#define UART_DR_PE                     0x00000200
+#define UART_DR_FE                     0x00000100
+#define UART_FR_TXFF                   0x00000020
+#define UART_FR_RXFE                   0x00000010
+#define UART_ICR_RTIC                  0x00000040
+#define UART_ICR_TXIC                  0x00000020
+#define UART_ICR_RXIC                  0x00000010
+#define UART_IM_RTIM                   0x00000040
+#define UART_IM_TXIM                   0x00000020
+#define UART_IM_RXIM                   0x00000010
+#define UART_MIS_RTMIS                 0x00000040
+#define UART_MIS_TXMIS                 0x00000020
+#define UART_MIS_RXMIS                 0x00000010
+#define UART_LCRH_FEN                  0x00000010
+#define UART_LCRH_WLEN_8               0x00000060
+#define UDMA_CHCTL_DSTINC_NONE         0xC0000000
+#define UDMA_CHCTL_DSTINC_M            0xC0000000
+#define UDMA_CHCTL_DSTINC_16           0x40000000
+#define UDMA_CHCTL_DSTSIZE_8           0x00000000
+#define UDMA_CHCTL_DSTSIZE_16          0x10000000
+#define UDMA_CHCTL_SRCINC_NONE         0x0C000000
+#define UDMA_CHCTL_SRCINC_M            0x0C000000
+#define UDMA_CHCTL_SRCINC_8            0x00000000
+#define UDMA_CHCTL_SRCSIZE_8           0x00000000
+#define UDMA_CHCTL_SRCSIZE_16          0x01000000
+#define UDMA_CHCTL_ARBSIZE_1           0x00000000
+#define UDMA_CHCTL_ARBSIZE_4           0x00008000
+#define UDMA_CHCTL_XFERMODE_M          0x00000007
+#define UDMA_CHCTL_XFERMODE_BASIC      0x00000001
+#define UDMA_CHCTL_XFERMODE_PINGPONG   0x00000003
+
+#endif /* TEST_TM4C123GH6PM_H_ */
@@ -0,0 +1,2 @@
+// uart.h includes "timer.h", which only resolves to Timer.h on case-insensitive file systems
+#include "Timer.h"
@@ -0,0 +1,52 @@
+/**
+ * test.h
+ *
+ * Minimal check macros for the host-built unit tests. Each test_<module>.c is its own program: it runs its
+ * checks, then returns test_report() from main so make sees a non-zero exit on any failure
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+#ifndef TEST_H_
+#define TEST_H_
+
+/* <----------| INCLUDES |----------> */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* <----------| DEFINES |----------> */
+
+static int test_checks = 0;
+static int test_failures = 0;
+
+// Counts a check and prints where it failed
+#define TEST_CHECK(condition) do { \
+    test_checks++; \
+    if (!(condition)) { \
+        test_failures++; \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+    } \
+} while (0)
+
+// Same, printing both values for integer comparisons
+#define TEST_CHECK_EQUAL(expected, actual) do { \
+    long long expectedValue = (long long)(expected); \
+    long long actualValue = (long long)(actual); \
+    test_checks++; \
+    if (expectedValue != actualValue) { \
+        test_failures++; \
+        printf("%s:%d: %s: expected %lld, got %lld\n", __FILE__, __LINE__, #actual, expectedValue, actualValue); \
+    } \
+} while (0)
+
+// Prints the tally for a suite and returns the process exit code
+static inline int test_report(const char *suite) {
+    printf("%s: %d checks, %d failed\n", suite, test_checks, test_failures);
+    return test_failures ? 1 : 0;
+}
+
+#endif /* TEST_H_ */
@@ -0,0 +1,294 @@
+/**
+ * test_adc.c
+ *
+ * Streams a ramp through continuous mode with the fake ADC and uDMA: every timer trigger converts one SS3 sample
+ * and moves it into the ping-pong buffer, and the SS3 vector should only fire when a half finishes. Then compares a
+ * single 16x-averaged SS3 read with an SS0 burst median on a noisy input with spikes, for latency and error. Last,
+ * sweeps every 12-bit code through adc_calculateIRDistanceMM() against a linear scan of the calibration table
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include <math.h>
+#include "test.h"
+#include "hw_stubs.h"
+#include "adc.h"
+#include "dma.h"
+#include "ir_table.h"
+
+/* <----------| DEFINES |----------> */
+
+#define TEST_SAMPLE_RATE_HZ 2000
+#define TEST_TRIALS 2000
+#define TEST_TRUE_LEVEL 2000   // What a noiseless sensor would read
+#define TEST_NOISE_LSB 20      // Standard deviation of the sensor's own noise
+#define TEST_SPIKE_LSB 1500    // Height of the occasional spike on the IR output
+#define TEST_SPIKE_PERCENT 3
+
+/* <----------| PRIVATE GLOBALS |----------> */
+
+// What the IR sensor is putting out right now
+static uint16_t analogLevel = 0;
+
+// Times the SS3 vector ran
+static uint32_t numInterrupts = 0;
+
+// State of the noise generator, fixed so every run sees the same input
+static uint32_t noiseState = 12345;
+
+/* <----------| PRIVATE METHODS |----------> */
+
+static uint16_t test_analogInput(void);
+
+// TEST_TRUE_LEVEL plus roughly Gaussian noise and the odd spike, one value per conversion
+static uint16_t test_noisyInput(void);
+
+// Uniform in [0, 1) from a fixed linear congruential generator
+static double test_uniform(void);
+
+// Same interpolation as adc.c, but finds the segment by walking the table from the near end
+static uint16_t test_irReference(uint16_t adcCode);
+
+// Runs read TEST_TRIALS times on the noisy input: mean microseconds per read, RMS error and worst error in LSB
+static void test_measure(uint16_t (*read)(void), double *micros, double *rms, double *worst);
+
+// One Timer 2A trigger: SS3 converts, uDMA takes the sample (unless stalled), and SS3's vector fires if the sample
+// interrupt is unmasked or uDMA finished a half. It stays pending until the completion is cleared
+static void test_trigger(uint16_t level, bool stalled);
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+static uint16_t test_analogInput(void) {
+    return analogLevel;
+}
+
+static void test_trigger(uint16_t level, bool stalled) {
+    uint8_t guard = 0;
+
+    analogLevel = level;
+
+    if (stalled) {
+        test_adcOverflow(0b1000);
+    }
+    else {
+        test_dmaRun(DMA_CHANNEL_ADC0_SS3, 1);
+    }
+
+    if (ADC0_IM_R & 0b1000) {
+        test_interrupt(INT_ADC0SS3);
+        numInterrupts++;
+    }
+    while (test_dma[DMA_CHANNEL_ADC0_SS3].completed && guard++ < 4) {
+        test_interrupt(INT_ADC0SS3);
+        numInterrupts++;
+    }
+}
+
+static double test_uniform(void) {
+    noiseState = noiseState * 1664525u + 1013904223u;
+    return (noiseState >> 8) / 16777216.0;
+}
+
+static uint16_t test_noisyInput(void) {
+    double noise = 0.0;
+    uint8_t i;
+
+    // Sum of 12 uniforms minus 6 is close enough to a unit normal
+    for (i = 0; i < 12; i++) {
+        noise += test_uniform();
+    }
+    noise = (noise - 6.0) * TEST_NOISE_LSB;
+
+    if (test_uniform() * 100.0 < TEST_SPIKE_PERCENT) {
+        noise += TEST_SPIKE_LSB;
+    }
+
+    return (uint16_t)(TEST_TRUE_LEVEL + noise + 0.5);
+}
+
+static void test_measure(uint16_t (*read)(void), double *micros, double *rms, double *worst) {
+    uint32_t start = test_micros;
+    double sumSquares = 0.0;
+    uint32_t i;
+
+    *worst = 0.0;
+    for (i = 0; i < TEST_TRIALS; i++) {
+        double error = (double)read() - TEST_TRUE_LEVEL;
+
+        sumSquares += error * error;
+        *worst = fabs(error) > *worst ? fabs(error) : *worst;
+    }
+
+    *micros = (double)(test_micros - start) / TEST_TRIALS;
+    *rms = sqrt(sumSquares / TEST_TRIALS);
+}
+
+int main(void) {
+    uint16_t samples[ADC_BURST_MAX];
+    double singleMicros, singleRMS, singleWorst;
+    double burstMicros, burstRMS, burstWorst;
+    uint16_t maxMM = IR_TABLE_START_MM + (IR_TABLE_LEN - 1) * IR_TABLE_STEP_MM;
+    uint16_t previous = IR_TABLE_START_MM;
+    uint16_t code, distance;
+    uint32_t interruptsBefore;
+    uint32_t i;
+
+    test_adcInput = test_analogInput;
+    ADC0_RIS_R = 0b1111; // Conversions finish instantly as far as the busy-waits are concerned
+    SYSCTL_PRTIMER_R = 0b11'1111;
+
+    adc_init();
+    adc_startContinuous(TEST_SAMPLE_RATE_HZ);
+
+    // 2 kHz from the 16 MHz clock, SS3 timer-triggered, ping-pong halves of 32 armed on the SS3 channel
+    TEST_CHECK_EQUAL(16000000 / TEST_SAMPLE_RATE_HZ - 1, TIMER2_TAILR_R);
+    TEST_CHECK_EQUAL(0x5, (ADC0_EMUX_R >> 12) & 0xF);
+    TEST_CHECK(dma_isChannelEnabled(DMA_CHANNEL_ADC0_SS3));
+    TEST_CHECK_EQUAL(ADC_STREAM_BUFFER_SIZE / 2, dma_getRemaining(DMA_CHANNEL_ADC0_SS3, false));
+    TEST_CHECK_EQUAL(ADC_STREAM_BUFFER_SIZE / 2, dma_getRemaining(DMA_CHANNEL_ADC0_SS3, true));
+
+    // SS3 still asks uDMA for every sample, but its own interrupt never reaches the NVIC
+    TEST_CHECK_EQUAL(0b0110, ADC0_SSCTL3_R & 0xF);
+    TEST_CHECK_EQUAL(0, ADC0_IM_R & 0b1000);
+
+    // Half a buffer in, nothing has interrupted the CPU yet
+    for (i = 0; i < ADC_STREAM_BUFFER_SIZE / 2 - 1; i++) {
+        test_trigger(i, false);
+    }
+    TEST_CHECK_EQUAL(0, numInterrupts);
+    TEST_CHECK_EQUAL(ADC_STREAM_BUFFER_SIZE / 2 - 1, adc_getSampleCount());
+
+    // The sample that finishes the half raises one interrupt, which clears the completion and re-arms the half
+    test_trigger(i++, false);
+    TEST_CHECK_EQUAL(1, numInterrupts);
+    TEST_CHECK(!test_dma[DMA_CHANNEL_ADC0_SS3].completed);
+    TEST_CHECK_EQUAL(ADC_STREAM_BUFFER_SIZE / 2, dma_getRemaining(DMA_CHANNEL_ADC0_SS3, false));
+    TEST_CHECK(dma_isAlternateActive(DMA_CHANNEL_ADC0_SS3));
+
+    // One second at 2 kHz: 2000 samples cost 62 interrupts, every sample is counted and none is lost
+    for (; i < TEST_SAMPLE_RATE_HZ; i++) {
+        test_trigger(i % 4096, false);
+    }
+    TEST_CHECK_EQUAL(TEST_SAMPLE_RATE_HZ / (ADC_STREAM_BUFFER_SIZE / 2), numInterrupts);
+    TEST_CHECK_EQUAL(TEST_SAMPLE_RATE_HZ, adc_getSampleCount());
+    TEST_CHECK_EQUAL(TEST_SAMPLE_RATE_HZ, test_dma[DMA_CHANNEL_ADC0_SS3].transfers);
+    TEST_CHECK(dma_isChannelEnabled(DMA_CHANNEL_ADC0_SS3));
+    TEST_CHECK_EQUAL(0, adc_getOverflowCount());
+
+    // The newest 8 samples are 1992 - 1999, and adc_read() takes them from the buffer without starting a conversion
+    TEST_CHECK_EQUAL(1995, adc_readLatest());
+    TEST_CHECK_EQUAL(1995, adc_read());
+
+    // Mid-half the newest samples still come out right across the wrap back to the start of the buffer
+    for (i = 0; i < 36; i++) {
+        test_trigger(100, false);
+    }
+    TEST_CHECK_EQUAL(100, adc_readLatest());
+    TEST_CHECK_EQUAL(TEST_SAMPLE_RATE_HZ + 36, adc_getSampleCount());
+
+    // uDMA falls behind and SS3's FIFO overflows: noticed, cleared and counted at the next completed half
+    interruptsBefore = numInterrupts;
+    test_trigger(100, true);
+    TEST_CHECK_EQUAL(0, adc_getOverflowCount());
+    while (numInterrupts == interruptsBefore) {
+        test_trigger(100, false);
+    }
+    TEST_CHECK_EQUAL(1, adc_getOverflowCount());
+    TEST_CHECK_EQUAL(0, ADC0_OSTAT_R & 0b1000);
+
+    // Stopping hands SS3 back to the processor trigger, and adc_read() converts again
+    adc_stopContinuous();
+    TEST_CHECK(!dma_isChannelEnabled(DMA_CHANNEL_ADC0_SS3));
+    TEST_CHECK_EQUAL(0, TIMER2_CTL_R & 0b0010'0001);
+    TEST_CHECK_EQUAL(0, (ADC0_EMUX_R >> 12) & 0xF);
+    analogLevel = 1234;
+    TEST_CHECK_EQUAL(1234, adc_read());
+
+    /* <----------| BURST VS SINGLE |----------> */
+
+    // One SS3 conversion with adc_init()'s 16x averaging: 16 us, and a spike in any of the 16 drags the mean along
+    test_adcInput = test_noisyInput;
+    test_measure(adc_read, &singleMicros, &singleRMS, &singleWorst);
+    TEST_CHECK(fabs(singleMicros - 16.0) < 0.01);
+
+    // SS0 takes 8 unaveraged samples in one trigger and adc_read() keeps their median
+    adc_initBurst(ADC_BURST_MAX, ADC_AVERAGING_NONE);
+    TEST_CHECK_EQUAL(0xAAAAAAAA, ADC0_SSMUX0_R);
+    TEST_CHECK_EQUAL(0b0110u << ((ADC_BURST_MAX - 1) * 4), ADC0_SSCTL0_R);
+    test_measure(adc_read, &burstMicros, &burstRMS, &burstWorst);
+    TEST_CHECK(fabs(burstMicros - 8.0) < 0.01);
+    TEST_CHECK_EQUAL(8, adc_getConversionMicros());
+    printf("adc: single 16x %.1f us, rms %.1f, worst %.0f LSB; burst median of 8 %.1f us, rms %.1f, worst %.0f LSB\n",
+           singleMicros, singleRMS, singleWorst, burstMicros, burstRMS, burstWorst);
+
+    // Half the latency, and the median throws spikes away instead of averaging them in
+    TEST_CHECK(burstMicros < singleMicros);
+    TEST_CHECK(burstRMS < singleRMS);
+    TEST_CHECK(burstWorst < singleWorst);
+    TEST_CHECK(burstWorst < TEST_SPIKE_LSB / 16);
+
+    // The burst's own averaging level is only in effect while it runs: SS3 is back at 16x afterwards
+    TEST_CHECK_EQUAL(ADC_AVERAGING_16X, ADC0_SAC_R & 0b111);
+
+    // Averaged bursts take 16 conversions per sample, and a partial burst ends and interrupts on its last sample
+    adc_initBurst(4, ADC_AVERAGING_16X);
+    TEST_CHECK_EQUAL(0b0110u << (3 * 4), ADC0_SSCTL0_R);
+    TEST_CHECK_EQUAL(4, adc_readBurst(samples));
+    TEST_CHECK_EQUAL(64, adc_getConversionMicros());
+    TEST_CHECK_EQUAL(ADC_AVERAGING_16X, ADC0_SAC_R & 0b111);
+
+    // Out-of-range lengths are clamped to what SS0 holds
+    adc_initBurst(0, ADC_AVERAGING_NONE);
+    TEST_CHECK_EQUAL(1, adc_readBurst(samples));
+    adc_initBurst(20, ADC_AVERAGING_NONE);
+    TEST_CHECK_EQUAL(ADC_BURST_MAX, adc_readBurst(samples));
+
+    /* <----------| IR TABLE |----------> */
+
+    // Every code the ADC can produce, plus a few past the top of the range
+    for (code = 0; code <= 4100; code++) {
+        distance = adc_calculateIRDistanceMM(code);
+        TEST_CHECK_EQUAL(test_irReference(code), distance);
+        TEST_CHECK(distance >= IR_TABLE_START_MM && distance <= maxMM);
+        if (code > 0) {
+            // A stronger return (higher code) never reads as further away
+            TEST_CHECK(distance <= previous);
+        }
+        previous = distance;
+    }
+
+    // Table entries land exactly on their calibration distances
+    for (i = 0; i < IR_TABLE_LEN; i++) {
+        TEST_CHECK_EQUAL(IR_TABLE_START_MM + i * IR_TABLE_STEP_MM, adc_calculateIRDistanceMM(IR_TABLE[i]));
+    }
+
+    // Clamps at both ends, and the reported maximum matches the far clamp
+    TEST_CHECK_EQUAL(IR_TABLE_START_MM, adc_calculateIRDistanceMM(4095));
+    TEST_CHECK_EQUAL(maxMM, adc_calculateIRDistanceMM(0));
+    TEST_CHECK_EQUAL(maxMM, adc_getIRMaxMillimeters());
+
+    // Centimeter form rounds to nearest
+    TEST_CHECK_EQUAL(10, adc_calculateIRDistance(IR_TABLE[0]));
+    TEST_CHECK_EQUAL((adc_calculateIRDistanceMM(2500) + 5) / 10, adc_calculateIRDistance(2500));
+
+    return test_report("adc");
+}
+
+static uint16_t test_irReference(uint16_t adcCode) {
+    uint8_t i;
+
+    if (adcCode >= IR_TABLE[0]) { return IR_TABLE_START_MM; }
+
+    for (i = 0; i + 1 < IR_TABLE_LEN; i++) {
+        if (adcCode > IR_TABLE[i + 1]) {
+            return IR_TABLE_START_MM + i * IR_TABLE_STEP_MM
+                 + ((uint32_t)(IR_TABLE[i] - adcCode) * IR_TABLE_STEP_MM) / (IR_TABLE[i] - IR_TABLE[i + 1]);
+        }
+    }
+
+    return IR_TABLE_START_MM + (IR_TABLE_LEN - 1) * IR_TABLE_STEP_MM;
+}
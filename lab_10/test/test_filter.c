@@ -0,0 +1,142 @@
+/**
+ * test_filter.c
+ *
+ * Checks filter_scan() against a brute-force reference that recomputes every window from an untouched copy of the
+ * input, for each kernel and window size, plus a few hand-worked spike cases
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "filter.h"
+
+/* <----------| DEFINES |----------> */
+
+#define TEST_NUM_VALUES 91
+
+/* <----------| PRIVATE METHODS |----------> */
+
+// Sorts values ascending and returns their median, rounding the mean of the middle pair up like filter.c
+static uint16_t test_median(uint16_t values[], uint8_t count);
+
+// Reference output for sample i of raw[] under the given kernel, window truncated at both ends of the scan
+static uint16_t test_reference(const uint16_t raw[], uint8_t numValues, uint8_t i, uint8_t windowSize, filter_kernel_t kernel);
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+int main(void) {
+    const uint8_t windows[] = { 1, 3, 5, 7, 15, 17 };
+    const filter_kernel_t kernels[] = { FILTER_KERNEL_BOX, FILTER_KERNEL_MEDIAN, FILTER_KERNEL_HAMPEL };
+    scanVector vectors[TEST_NUM_VALUES];
+    uint16_t rawPing[TEST_NUM_VALUES], rawIR[TEST_NUM_VALUES], rawFused[TEST_NUM_VALUES];
+    uint8_t w, k, i, trial;
+
+    srand(1);
+
+    // Random scans with spikes, every kernel and window size, all three fields in one pass
+    for (trial = 0; trial < 20; trial++) {
+        for (w = 0; w < sizeof(windows); w++) {
+            for (k = 0; k < 3; k++) {
+                for (i = 0; i < TEST_NUM_VALUES; i++) {
+                    rawPing[i] = 40 + rand() % 20 + (rand() % 10 == 0 ? 150 : 0);
+                    rawIR[i] = 30 + rand() % 5;
+                    rawFused[i] = 400 + rand() % 300 + (rand() % 8 == 0 ? 2000 : 0);
+                    vectors[i].angle = 2 * i;
+                    vectors[i].pingDistance = rawPing[i];
+                    vectors[i].irDistance = rawIR[i];
+                    vectors[i].fusedDistance = rawFused[i];
+                }
+
+                filter_scan(vectors, TEST_NUM_VALUES, windows[w], kernels[k], FILTER_FIELD_PING | FILTER_FIELD_IR | FILTER_FIELD_FUSED);
+
+                for (i = 0; i < TEST_NUM_VALUES; i++) {
+                    TEST_CHECK_EQUAL(test_reference(rawPing, TEST_NUM_VALUES, i, windows[w], kernels[k]), vectors[i].pingDistance);
+                    TEST_CHECK_EQUAL(test_reference(rawIR, TEST_NUM_VALUES, i, windows[w], kernels[k]), vectors[i].irDistance);
+                    TEST_CHECK_EQUAL(test_reference(rawFused, TEST_NUM_VALUES, i, windows[w], kernels[k]), vectors[i].fusedDistance);
+                }
+            }
+        }
+    }
+
+    // A lone spike disappears under the median, and only the selected field is touched
+    memset(vectors, 0, sizeof(vectors));
+    for (i = 0; i < 5; i++) {
+        vectors[i].pingDistance = i == 2 ? 200 : 10;
+        vectors[i].irDistance = i == 2 ? 99 : 20;
+    }
+    filter_scan(vectors, 5, 5, FILTER_KERNEL_MEDIAN, FILTER_FIELD_PING);
+    TEST_CHECK_EQUAL(10, vectors[2].pingDistance);
+    TEST_CHECK_EQUAL(99, vectors[2].irDistance);
+
+    // Hampel keeps an edge (a step is not an outlier against its own window) but replaces the spike
+    for (i = 0; i < 10; i++) {
+        vectors[i].fusedDistance = i < 5 ? 500 : 900;
+    }
+    vectors[7].fusedDistance = 3000;
+    filter_scan(vectors, 10, 5, FILTER_KERNEL_HAMPEL, FILTER_FIELD_FUSED);
+    TEST_CHECK_EQUAL(500, vectors[4].fusedDistance);
+    TEST_CHECK_EQUAL(900, vectors[5].fusedDistance);
+    TEST_CHECK_EQUAL(900, vectors[7].fusedDistance);
+
+    // Nothing to do on an empty scan
+    filter_scan(vectors, 0, 5, FILTER_KERNEL_BOX, FILTER_FIELD_FUSED);
+
+    return test_report("filter");
+}
+
+static uint16_t test_median(uint16_t values[], uint8_t count) {
+    uint8_t i, j;
+    uint16_t value;
+
+    for (i = 1; i < count; i++) {
+        for (j = i; j > 0 && values[j - 1] > values[j]; j--) {
+            value = values[j];
+            values[j] = values[j - 1];
+            values[j - 1] = value;
+        }
+    }
+
+    if (count & 1) { return values[count / 2]; }
+    return ((uint32_t)values[count / 2 - 1] + values[count / 2] + 1) / 2;
+}
+
+static uint16_t test_reference(const uint16_t raw[], uint8_t numValues, uint8_t i, uint8_t windowSize, filter_kernel_t kernel) {
+    uint8_t radius = (windowSize > FILTER_MAX_WINDOW ? FILTER_MAX_WINDOW : windowSize) / 2;
+    uint8_t first = i > radius ? i - radius : 0;
+    uint8_t last = i + radius < numValues ? i + radius : numValues - 1;
+    uint8_t count = last - first + 1;
+    uint16_t values[FILTER_MAX_WINDOW];
+    uint16_t median, mad;
+    uint32_t sum = 0;
+    uint8_t j;
+
+    for (j = 0; j < count; j++) {
+        values[j] = raw[first + j];
+        sum += values[j];
+    }
+
+    if (kernel == FILTER_KERNEL_BOX) {
+        return (sum + count / 2) / count;
+    }
+
+    median = test_median(values, count);
+    if (kernel == FILTER_KERNEL_MEDIAN) {
+        return median;
+    }
+
+    for (j = 0; j < count; j++) {
+        values[j] = values[j] > median ? values[j] - median : median - values[j];
+    }
+    mad = test_median(values, count);
+
+    if ((uint32_t)abs(raw[i] - median) * 1000 > (uint32_t)mad * FILTER_HAMPEL_THRESHOLD_X1000) {
+        return median;
+    }
+    return raw[i];
+}
@@ -0,0 +1,93 @@
+/**
+ * test_map.c
+ *
+ * Fires single rays into the occupancy grid and checks the hit cell, the free cells in front of it and the cells
+ * it should not touch, for several headings, plus the no-return and off-map cases
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include "test.h"
+#include "map.h"
+
+/* <----------| PRIVATE METHODS |----------> */
+
+// Adds a one-ray scan at angle (90 = straight ahead) returning distanceMM with the given variance
+static void test_ray(const map_pose_t *pose, uint8_t angle, uint16_t distanceMM, uint32_t variance);
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+int main(void) {
+    map_pose_t origin = { 0, 0, 0 };
+    map_pose_t facingY = { 0, 0, 90 };
+    map_pose_t offMap = { 2200, 0, 180 };
+    uint8_t i;
+
+    // Sensor sits MAP_SENSOR_OFFSET_MM ahead of the pose, so a 500 mm return straight ahead lands at x = 620
+    map_init();
+    TEST_CHECK_EQUAL(MAP_UNKNOWN, map_getCell(620, 0));
+    test_ray(&origin, 90, 500, 100);
+    TEST_CHECK_EQUAL(MAP_UNKNOWN + MAP_HIT_STEP, map_getCell(620, 0));
+    TEST_CHECK(map_isOccupied(620, 0));
+    TEST_CHECK_EQUAL(MAP_UNKNOWN - MAP_MISS_STEP, map_getCell(130, 0));
+    TEST_CHECK_EQUAL(MAP_UNKNOWN - MAP_MISS_STEP, map_getCell(400, 0));
+    TEST_CHECK_EQUAL(MAP_UNKNOWN - MAP_MISS_STEP, map_getCell(600, 0));
+    TEST_CHECK_EQUAL(MAP_UNKNOWN, map_getCell(640, 0));    // past the hit
+    TEST_CHECK_EQUAL(MAP_UNKNOWN, map_getCell(0, 0));      // behind the sensor
+    TEST_CHECK_EQUAL(MAP_UNKNOWN, map_getCell(400, 40));   // beside the ray
+
+    // Evidence accumulates and saturates at both ends
+    for (i = 0; i < 10; i++) {
+        test_ray(&origin, 90, 500, 100);
+    }
+    TEST_CHECK_EQUAL(MAP_MAX_ODDS, map_getCell(620, 0));
+    TEST_CHECK_EQUAL(0, map_getCell(400, 0));
+    TEST_CHECK(!map_isOccupied(400, 0));
+
+    // Scan angle 0 is the bot's right (-y), and the pose heading rotates everything
+    map_init();
+    test_ray(&origin, 0, 500, 100);
+    TEST_CHECK(map_isOccupied(120, -500));
+    test_ray(&facingY, 90, 500, 100);
+    TEST_CHECK(map_isOccupied(0, 620));
+    test_ray(&origin, 135, 500, 100);                      // 45 degrees left: (120 + 354, 354)
+    TEST_CHECK(map_isOccupied(474, 354));
+    TEST_CHECK_EQUAL(MAP_UNKNOWN - MAP_MISS_STEP, map_getCell(297, 177));
+
+    // No return (or one past MAP_MAX_RANGE_MM) only clears out to MAP_NO_RETURN_FREE_MM, and marks nothing occupied
+    map_init();
+    test_ray(&origin, 90, 3000, SCAN_VARIANCE_UNKNOWN);
+    TEST_CHECK_EQUAL(MAP_UNKNOWN - MAP_MISS_STEP, map_getCell(1110, 0));
+    TEST_CHECK_EQUAL(MAP_UNKNOWN, map_getCell(1200, 0));
+    test_ray(&facingY, 90, MAP_MAX_RANGE_MM + 1, 100);
+    TEST_CHECK_EQUAL(MAP_UNKNOWN - MAP_MISS_STEP, map_getCell(0, 1110));
+    TEST_CHECK_EQUAL(MAP_UNKNOWN, map_getCell(0, 2600));
+
+    // Off the map: reads are unknown and a scan taken from there is ignored
+    TEST_CHECK_EQUAL(MAP_UNKNOWN, map_getCell(-2001, 0));
+    TEST_CHECK_EQUAL(MAP_UNKNOWN, map_getCell(0, 2000));
+    map_init();
+    test_ray(&offMap, 90, 500, 100);                       // sensor at x = 2080, aiming back in at x = 1580
+    TEST_CHECK_EQUAL(MAP_UNKNOWN, map_getCell(1990, 0));
+    TEST_CHECK_EQUAL(MAP_UNKNOWN, map_getCell(1580, 0));
+
+    // A ray that leaves the map stops at the edge
+    map_init();
+    test_ray(&origin, 90, 2400, 100);
+    TEST_CHECK_EQUAL(MAP_UNKNOWN - MAP_MISS_STEP, map_getCell(1990, 0));
+
+    return test_report("map");
+}
+
+static void test_ray(const map_pose_t *pose, uint8_t angle, uint16_t distanceMM, uint32_t variance) {
+    scanVector vector = { 0 };
+
+    vector.angle = angle;
+    vector.fusedDistance = distanceMM;
+    vector.fusedVariance = variance;
+    map_addScan(&vector, 1, pose);
+}
@@ -0,0 +1,537 @@
+/**
+ * test_open_interface.c
+ *
+ * Replays encoder counts through oi_update() polling and checks the dead-reckoned pose against the closed-form
+ * result for a straight line, a spin in place past the heading wrap and a constant-radius arc, how far apart the
+ * polled requests go out, which counter each UART receive error lands in and that a batch sends exactly the bytes
+ * of the single-command calls it replaces. Then streams frames
+ * from a simulated Create every 15 ms and checks that oi_update() hands each one out once and that movement.c
+ * paces its wheel commands on them. Last, feeds hand-built frames through the UART4 interrupt handler and checks
+ * what the parser accepts, what it drops and what it counts, then the polling timeout once the stream is stopped,
+ * and finally that oi_checkFirmware() finds the version in a reset banner and gives up on a missing one
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include "test.h"
+#include "hw_stubs.h"
+#include "open_interface.h"
+#include "movement.h"
+
+/* <----------| DEFINES |----------> */
+
+#define TEST_MM_PER_TICK (72.0 * M_PI / 508.8)
+#define TEST_WHEEL_BASE_MM 235.0
+#define TEST_POSE_TOLERANCE_MM 0.5
+#define TEST_HEADING_TOLERANCE 1e-3
+#define TEST_STREAM_HEADER 19
+#define TEST_STREAM_PERIOD_MICROS 15000
+#define TEST_OPCODE_DRIVE_WHEELS 145
+#define TEST_OPCODE_QUERY_LIST 149
+#define TEST_OPCODE_RESET 7
+#define TEST_REQUEST_GAP_MICROS 15000
+#define TEST_NUM_REQUESTS 20
+#define TEST_FIRMWARE_TIMEOUT_MICROS 5'000'000
+
+/* <----------| PRIVATE GLOBALS |----------> */
+
+// Encoder counts the simulated Create reports, free-running like the real ones
+static int16_t leftCount = 0;
+static int16_t rightCount = 0;
+
+// Simulated Create while streaming: the wheel speeds it was last sent, where its encoders are between ticks and
+// when its next frame is due. Wheel command timing is kept to check the sender's pacing
+static bool createStreaming = false;
+static bool createBusy = false;
+static int16_t createLeftSpeed = 0;
+static int16_t createRightSpeed = 0;
+static float createLeftTicks = 0.0f;
+static float createRightTicks = 0.0f;
+static uint32_t createNextFrameMicros = 0;
+static uint32_t createFrames = 0;
+static uint32_t wheelCommands = 0;
+static uint32_t lastWheelMicros = 0;
+static uint32_t minWheelGapMicros = UINT32_MAX;
+
+// When each polled sensor request reached UART4
+static uint32_t requestMicros[TEST_NUM_REQUESTS];
+static uint8_t requestCount = 0;
+
+/* <----------| PRIVATE METHODS |----------> */
+
+// Moves the wheels by leftTicks and rightTicks per update for steps updates, each one answered over UART4
+static void test_replay(oi_t *sensor, int16_t leftTicks, int16_t rightTicks, uint16_t steps);
+
+// Heading difference folded into (-pi, pi], so a wrapped heading compares equal to the unwrapped one
+static double test_angleError(double heading, double expected);
+
+// Queues [19][length][body...][checksum], optionally with a bad checksum, lets the line go idle and runs the
+// UART4 interrupt
+static void test_streamFrame(const uint8_t body[], uint8_t length, bool corrupt);
+
+// test_onAdvance hook: reads wheel commands off UART4 and sends a bumps/encoders frame every 15 ms
+static void test_simulateCreate(void);
+
+// test_onAdvance hook: time stamps each sensor request as it shows up on UART4
+static void test_timeRequests(void);
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+int main(void) {
+    oi_t *sensor = oi_alloc();
+    const oi_pose_t *pose = oi_getPose();
+    double turn, radius, traveled;
+    uint32_t start;
+    uint8_t sent[64];
+    uint8_t i;
+    oi_stats_t stats;
+    oi_batch_t batch;
+    uint8_t perCall[64], batched[64];
+    uint16_t perCallLength, batchedLength;
+    unsigned char notes[] = { 60, 64, 67 };
+    unsigned char durations[] = { 16, 16, 32 };
+    const uint8_t garbage[] = { 0x55, 0xAA };
+    const uint8_t lateHeader[] = { TEST_STREAM_HEADER };
+    // Packets 7, 43 and 44: bumps/drops, then the left and right encoder counts big-endian
+    uint8_t frame[] = { 7, 0x03, 43, 0x12, 0x34, 44, 0x01, 0x02 };
+    // Packets 8 and 27 once the query list is switched to OI_FIELD_WALL
+    const uint8_t wallFrame[] = { 8, 1, 27, 0x02, 0x9A };
+    const uint8_t wallReply[] = { 0, 0x00, 0x40 };
+
+    test_clockStep = 10;
+    test_dmaAutoComplete = true;
+    oi_setQueryFields(OI_FIELD_ENCODERS);
+
+    // The first reply only sets the reference counts. Start near the top of the int16 range so the straight
+    // line below wraps both encoders
+    leftCount = 32000;
+    rightCount = 32000;
+    test_replay(sensor, 0, 0, 1);
+    TEST_CHECK(pose->x == 0.0f && pose->y == 0.0f && pose->heading == 0.0f);
+
+    /* <----------| STRAIGHT LINE |----------> */
+
+    // 200 updates of 50 ticks on both wheels, through the encoder wrap: x = 10000 ticks, nothing else moves
+    test_replay(sensor, 50, 50, 200);
+    TEST_CHECK(leftCount < 0 && rightCount < 0);
+    TEST_CHECK(fabs(pose->x - 10000 * TEST_MM_PER_TICK) < TEST_POSE_TOLERANCE_MM);
+    TEST_CHECK(fabs(pose->y) < TEST_POSE_TOLERANCE_MM);
+    TEST_CHECK(fabs(pose->heading) < TEST_HEADING_TOLERANCE);
+
+    // Reversing comes straight back
+    test_replay(sensor, -50, -50, 200);
+    TEST_CHECK(fabs(pose->x) < TEST_POSE_TOLERANCE_MM);
+
+    /* <----------| SPIN IN PLACE |----------> */
+
+    // Wheels in opposite directions: heading turns 2 * d / wheel base, the center stays put. 300 updates of 10 ticks
+    // is about 1.4 turns counter-clockwise, so the heading wraps past pi once and has to land on the folded angle
+    oi_setPose(0.0f, 0.0f, 0.0f);
+    test_replay(sensor, -10, 10, 300);
+    turn = 2.0 * 3000 * TEST_MM_PER_TICK / TEST_WHEEL_BASE_MM;
+    TEST_CHECK(turn > 2.0 * M_PI + M_PI / 2);
+    TEST_CHECK(fabs(test_angleError(pose->heading, turn)) < TEST_HEADING_TOLERANCE);
+    TEST_CHECK(pose->heading > -M_PI && pose->heading <= M_PI);
+    TEST_CHECK(fabs(pose->x) < TEST_POSE_TOLERANCE_MM && fabs(pose->y) < TEST_POSE_TOLERANCE_MM);
+
+    // Clockwise back past the wrap the other way
+    test_replay(sensor, 10, -10, 300);
+    TEST_CHECK(fabs(test_angleError(pose->heading, 0.0)) < TEST_HEADING_TOLERANCE);
+
+    /* <----------| CONSTANT-RADIUS ARC |----------> */
+
+    // 20 and 30 ticks per update: radius = base / 2 * (r + l) / (r - l) = 587.5 mm to the left, and after 150 updates
+    // the heading is (r - l) * 150 ticks / base. The center sits at (0, R), so x = R sin(turn), y = R (1 - cos(turn))
+    oi_setPose(0.0f, 0.0f, 0.0f);
+    test_replay(sensor, 20, 30, 150);
+    radius = TEST_WHEEL_BASE_MM / 2 * (30 + 20) / (30 - 20);
+    turn = (30 - 20) * 150 * TEST_MM_PER_TICK / TEST_WHEEL_BASE_MM;
+    TEST_CHECK(fabs(pose->x - radius * sin(turn)) < TEST_POSE_TOLERANCE_MM);
+    TEST_CHECK(fabs(pose->y - radius * (1 - cos(turn))) < TEST_POSE_TOLERANCE_MM);
+    TEST_CHECK(fabs(test_angleError(pose->heading, turn)) < TEST_HEADING_TOLERANCE);
+
+    // The same arc from a rotated start is the same curve rotated about the origin
+    oi_setPose(0.0f, 0.0f, (float)(M_PI / 2));
+    test_replay(sensor, 20, 30, 150);
+    TEST_CHECK(fabs(pose->x + radius * (1 - cos(turn))) < TEST_POSE_TOLERANCE_MM);
+    TEST_CHECK(fabs(pose->y - radius * sin(turn)) < TEST_POSE_TOLERANCE_MM);
+    TEST_CHECK(fabs(test_angleError(pose->heading, turn + M_PI / 2)) < TEST_HEADING_TOLERANCE);
+
+    /* <----------| REQUEST PACING |----------> */
+
+    // A Create that answers at once: requests still go out no closer than its 15 ms update period, and no later
+    // than needed. Clock readings that straddle a millisecond boundary must not shave any time off
+    test_onAdvance = test_timeRequests;
+    for (i = 0; i < TEST_NUM_REQUESTS; i++) {
+        test_uartQueue(TEST_UART4, (const uint8_t[]){ (uint8_t)((uint16_t)leftCount >> 8), (uint8_t)leftCount,
+                                                      (uint8_t)((uint16_t)rightCount >> 8), (uint8_t)rightCount }, 4);
+        test_advance(i * 137); // Work between updates, a different fraction of a millisecond each time
+        TEST_CHECK_EQUAL(OI_STATUS_OK, oi_update(sensor));
+    }
+    test_onAdvance = NULL;
+    TEST_CHECK_EQUAL(TEST_NUM_REQUESTS, requestCount);
+    for (i = 1; i < requestCount; i++) {
+        TEST_CHECK(requestMicros[i] - requestMicros[i - 1] >= TEST_REQUEST_GAP_MICROS);
+        TEST_CHECK(requestMicros[i] - requestMicros[i - 1] < TEST_REQUEST_GAP_MICROS + 100);
+    }
+
+    /* <----------| RECEIVE ERRORS |----------> */
+
+    // One flag per reply byte, each lands in its own counter and nowhere else
+    test_uartQueueWithFlags(TEST_UART4, (uint8_t)((uint16_t)leftCount >> 8), UART_DR_FE);
+    test_uartQueueWithFlags(TEST_UART4, (uint8_t)leftCount, UART_DR_PE);
+    test_uartQueueWithFlags(TEST_UART4, (uint8_t)((uint16_t)rightCount >> 8), UART_DR_BE);
+    test_uartQueueWithFlags(TEST_UART4, (uint8_t)rightCount, UART_DR_OE);
+    TEST_CHECK_EQUAL(OI_STATUS_OK, oi_update(sensor));
+    stats = oi_getStats();
+    TEST_CHECK_EQUAL(1, stats.framingErrors);
+    TEST_CHECK_EQUAL(1, stats.parityErrors);
+    TEST_CHECK_EQUAL(1, stats.breakErrors);
+    TEST_CHECK_EQUAL(1, stats.overruns);
+
+    // Two flags on one byte count once in each
+    test_uartQueueWithFlags(TEST_UART4, (uint8_t)((uint16_t)leftCount >> 8), UART_DR_FE | UART_DR_OE);
+    test_uartQueue(TEST_UART4, (const uint8_t[]){ (uint8_t)leftCount, (uint8_t)((uint16_t)rightCount >> 8),
+                                                  (uint8_t)rightCount }, 3);
+    TEST_CHECK_EQUAL(OI_STATUS_OK, oi_update(sensor));
+    stats = oi_getStats();
+    TEST_CHECK_EQUAL(2, stats.framingErrors);
+    TEST_CHECK_EQUAL(1, stats.parityErrors);
+    TEST_CHECK_EQUAL(1, stats.breakErrors);
+    TEST_CHECK_EQUAL(2, stats.overruns);
+    TEST_CHECK_EQUAL(0, stats.timeouts);
+
+    /* <----------| BATCHES |----------> */
+
+    // One uDMA transfer carries byte for byte what the single-command calls send one at a time
+    test_uartSent(TEST_UART4, sent, sizeof(sent));
+    oi_setWheels(200, -200);
+    oi_setLeds(1, 1, 7, 255);
+    oi_loadSong(2, 3, notes, durations);
+    oi_play_song(2);
+    perCallLength = test_uartSent(TEST_UART4, perCall, sizeof(perCall));
+    oi_batchBegin(&batch);
+    oi_batchWheels(&batch, 200, -200);
+    oi_batchLeds(&batch, 1, 1, 7, 255);
+    oi_batchSong(&batch, 2, 3, notes, durations);
+    oi_batchPlaySong(&batch, 2);
+    TEST_CHECK(oi_batchSubmit(&batch));
+    batchedLength = test_uartSent(TEST_UART4, batched, sizeof(batched));
+    TEST_CHECK_EQUAL(5 + 4 + 9 + 2, perCallLength);
+    TEST_CHECK_EQUAL(perCallLength, batchedLength);
+    TEST_CHECK(memcmp(perCall, batched, perCallLength) == 0);
+
+    // Against the OI spec: Drive Direct right then left, big-endian, then Song and Play
+    TEST_CHECK(memcmp(batched, (const uint8_t[]){ 145, 0x00, 0xC8, 0xFF, 0x38 }, 5) == 0);
+    TEST_CHECK(memcmp(batched + 9, (const uint8_t[]){ 140, 2, 3, 60, 16, 64, 16, 67, 32, 141, 2 }, 11) == 0);
+
+    // Commands batched with a sensor update go out right ahead of the same query oi_update() sends
+    test_advance(TEST_REQUEST_GAP_MICROS);
+    oi_batchBegin(&batch);
+    oi_batchWheels(&batch, 100, 100);
+    test_uartQueue(TEST_UART4, (const uint8_t[]){ (uint8_t)((uint16_t)leftCount >> 8), (uint8_t)leftCount,
+                                                  (uint8_t)((uint16_t)rightCount >> 8), (uint8_t)rightCount }, 4);
+    TEST_CHECK_EQUAL(OI_STATUS_OK, oi_updateBatch(sensor, &batch));
+    TEST_CHECK_EQUAL(9, test_uartSent(TEST_UART4, batched, sizeof(batched)));
+    TEST_CHECK(memcmp(batched, (const uint8_t[]){ 145, 0, 100, 0, 100, TEST_OPCODE_QUERY_LIST, 2, 43, 44 }, 9) == 0);
+
+    // A batch too big to take the query is refused without waiting or sending anything, and is not a request:
+    // the next update, a full gap after the last real one, goes straight out
+    test_advance(TEST_REQUEST_GAP_MICROS);
+    oi_batchBegin(&batch);
+    for (i = 0; i < OI_BATCH_MAX / 5; i++) {
+        oi_batchWheels(&batch, 0, 0);
+    }
+    oi_batchPlaySong(&batch, 2);
+    TEST_CHECK(!batch.overflow);
+    start = test_micros;
+    TEST_CHECK_EQUAL(OI_STATUS_OVERFLOW, oi_updateBatch(sensor, &batch));
+    TEST_CHECK_EQUAL(0, test_uartSent(TEST_UART4, batched, sizeof(batched)));
+    test_uartQueue(TEST_UART4, (const uint8_t[]){ (uint8_t)((uint16_t)leftCount >> 8), (uint8_t)leftCount,
+                                                  (uint8_t)((uint16_t)rightCount >> 8), (uint8_t)rightCount }, 4);
+    TEST_CHECK_EQUAL(OI_STATUS_OK, oi_update(sensor));
+    TEST_CHECK(test_micros - start < 1000);
+
+    /* <----------| STREAM PACING |----------> */
+
+    oi_setQueryFields(OI_FIELD_BUMPS_DROPS | OI_FIELD_ENCODERS);
+    oi_startStream();
+    test_uartSent(TEST_UART4, sent, sizeof(sent));
+    createNextFrameMicros = test_micros + TEST_STREAM_PERIOD_MICROS;
+    createStreaming = true;
+    test_onAdvance = test_simulateCreate;
+
+    // Each frame is handed out once: nothing yet, then the frame, then nothing again until the next one
+    TEST_CHECK_EQUAL(OI_STATUS_NO_FRAME, oi_update(sensor));
+    test_advance(TEST_STREAM_PERIOD_MICROS);
+    TEST_CHECK_EQUAL(OI_STATUS_OK, oi_update(sensor));
+    TEST_CHECK_EQUAL(OI_STATUS_NO_FRAME, oi_update(sensor));
+    TEST_CHECK(sensor->distance == 0 && sensor->angle == 0);
+    test_advance(TEST_STREAM_PERIOD_MICROS);
+    TEST_CHECK_EQUAL(OI_STATUS_OK, oi_update(sensor));
+
+    // A 50 cm precise drive ramps up, cruises and ramps down with one wheel command per frame at most. Streaming
+    // returns at once, so unpaced loops would send the whole ramp within a couple of milliseconds
+    wheelCommands = 0;
+    start = test_micros;
+    traveled = bot_driveDistancePrecise(sensor, BOT_CRUISE_SPEED, 50.0);
+    test_advance(TEST_STREAM_PERIOD_MICROS); // Let the simulation see the final stop
+    printf("open_interface: 50 cm drive took %u ms, %u frames, %u wheel commands at least %u us apart\n",
+           (unsigned int)((test_micros - start) / 1000), (unsigned int)createFrames, (unsigned int)wheelCommands,
+           (unsigned int)minWheelGapMicros);
+    TEST_CHECK(fabs(traveled - 50.0) < 1.0);
+    TEST_CHECK(test_micros - start > 500 * 1'000'000 / BOT_CRUISE_SPEED);
+    TEST_CHECK(wheelCommands >= 10);
+    TEST_CHECK(minWheelGapMicros >= TEST_STREAM_PERIOD_MICROS * 2 / 3);
+    TEST_CHECK_EQUAL(0, createLeftSpeed);
+    TEST_CHECK_EQUAL(0, createRightSpeed);
+
+    createStreaming = false;
+    test_onAdvance = NULL;
+
+    /* <----------| STREAM PARSER |----------> */
+
+    // Each packet costs an ID byte plus its data. Restarting the stream clears its counters
+    TEST_CHECK_EQUAL(5, oi_getQueryBytes());
+    oi_startStream();
+
+    // Nothing parsed yet
+    TEST_CHECK_EQUAL(OI_STATUS_NO_FRAME, oi_update(sensor));
+
+    // A clean frame lands in oi_t
+    test_streamFrame(frame, sizeof(frame), false);
+    TEST_CHECK_EQUAL(OI_STATUS_OK, oi_update(sensor));
+    TEST_CHECK_EQUAL(1, sensor->bumpLeft);
+    TEST_CHECK_EQUAL(1, sensor->bumpRight);
+    TEST_CHECK_EQUAL(0, sensor->wheelDropLeft);
+    TEST_CHECK_EQUAL(0x1234, sensor->leftEncoderCount);
+    TEST_CHECK_EQUAL(0x0102, sensor->rightEncoderCount);
+    stats = oi_getStats();
+    TEST_CHECK_EQUAL(1, stats.frames);
+    TEST_CHECK_EQUAL(0, stats.resyncs);
+
+    // A bad checksum is counted and dropped, so there is no new frame and oi_t keeps the last good one
+    frame[1] = 0x08;
+    frame[4] = 0x99;
+    test_streamFrame(frame, sizeof(frame), true);
+    TEST_CHECK_EQUAL(OI_STATUS_NO_FRAME, oi_update(sensor));
+    TEST_CHECK_EQUAL(0, sensor->wheelDropLeft);
+    TEST_CHECK_EQUAL(0x1234, sensor->leftEncoderCount);
+    stats = oi_getStats();
+    TEST_CHECK_EQUAL(1, stats.frames);
+    TEST_CHECK_EQUAL(1, stats.checksumErrors);
+
+    // Bytes ahead of a header are skipped one resync each
+    test_uartQueue(TEST_UART4, garbage, sizeof(garbage));
+    test_streamFrame(frame, sizeof(frame), false);
+    TEST_CHECK_EQUAL(OI_STATUS_OK, oi_update(sensor));
+    TEST_CHECK_EQUAL(1, sensor->wheelDropLeft);
+    TEST_CHECK_EQUAL(0x1299, sensor->leftEncoderCount);
+    stats = oi_getStats();
+    TEST_CHECK_EQUAL(2, stats.frames);
+    TEST_CHECK_EQUAL(2, stats.resyncs);
+
+    // A stray 19 right before the real header is taken for one, then the real header still gets through
+    test_uartQueue(TEST_UART4, lateHeader, sizeof(lateHeader));
+    test_streamFrame(frame, sizeof(frame), false);
+    stats = oi_getStats();
+    TEST_CHECK_EQUAL(3, stats.frames);
+    TEST_CHECK_EQUAL(3, stats.resyncs);
+
+    // A frame split across two interrupts without the line going idle (an RX interrupt, no receive timeout) is fine...
+    frame[6] = 0x05;
+    test_uartQueue(TEST_UART4, (const uint8_t[]){ TEST_STREAM_HEADER, sizeof(frame), 7, 0x08 }, 4);
+    test_interrupt(INT_UART4);
+    test_uartQueue(TEST_UART4, (const uint8_t[]){ 43, 0x12, 0x99, 44, 0x05, 0x02,
+                   (uint8_t)-(TEST_STREAM_HEADER + sizeof(frame) + 7 + 0x08 + 43 + 0x12 + 0x99 + 44 + 0x05 + 0x02) }, 7);
+    test_uartIdle(TEST_UART4);
+    test_interrupt(INT_UART4);
+    TEST_CHECK_EQUAL(OI_STATUS_OK, oi_update(sensor));
+    TEST_CHECK_EQUAL(0x0502, sensor->rightEncoderCount);
+    stats = oi_getStats();
+    TEST_CHECK_EQUAL(4, stats.frames);
+    TEST_CHECK_EQUAL(3, stats.resyncs);
+
+    // ...but a receive timeout mid-frame abandons it, and the next full frame is parsed from its own header
+    test_uartQueue(TEST_UART4, (const uint8_t[]){ TEST_STREAM_HEADER, sizeof(frame), 7, 0x08 }, 4);
+    test_uartIdle(TEST_UART4);
+    test_interrupt(INT_UART4);
+    frame[6] = 0x06;
+    test_streamFrame(frame, sizeof(frame), false);
+    TEST_CHECK_EQUAL(OI_STATUS_OK, oi_update(sensor));
+    TEST_CHECK_EQUAL(0x0602, sensor->rightEncoderCount);
+    stats = oi_getStats();
+    TEST_CHECK_EQUAL(5, stats.frames);
+    TEST_CHECK_EQUAL(4, stats.resyncs);
+    TEST_CHECK_EQUAL(1, stats.checksumErrors);
+
+    // The handler never reads the clock
+    start = test_micros;
+    test_streamFrame(frame, sizeof(frame), false);
+    TEST_CHECK_EQUAL(start, test_micros);
+    TEST_CHECK_EQUAL(6, oi_getStats().frames);
+
+    // A new query list makes frames in the old layout unusable until one in the new layout arrives
+    oi_setQueryFields(OI_FIELD_WALL);
+    TEST_CHECK_EQUAL(3, oi_getQueryBytes());
+    TEST_CHECK_EQUAL(OI_STATUS_NO_FRAME, oi_update(sensor));
+    test_streamFrame(frame, sizeof(frame), false);
+    stats = oi_getStats();
+    TEST_CHECK_EQUAL(6, stats.frames);
+    test_streamFrame(wallFrame, sizeof(wallFrame), false);
+    TEST_CHECK_EQUAL(OI_STATUS_OK, oi_update(sensor));
+    TEST_CHECK_EQUAL(1, sensor->wallSensor);
+    TEST_CHECK_EQUAL(0x029A, sensor->wallSignal);
+
+    // Polling: a full reply is parsed, a missing one times out and is counted
+    oi_stopStream();
+    test_uartQueue(TEST_UART4, wallReply, sizeof(wallReply));
+    TEST_CHECK_EQUAL(OI_STATUS_OK, oi_update(sensor));
+    TEST_CHECK_EQUAL(0, sensor->wallSensor);
+    TEST_CHECK_EQUAL(0x0040, sensor->wallSignal);
+    TEST_CHECK_EQUAL(OI_STATUS_TIMEOUT, oi_update(sensor));
+    TEST_CHECK_EQUAL(0, sensor->distance);
+    TEST_CHECK_EQUAL(1, oi_getStats().timeouts);
+    TEST_CHECK_EQUAL(0, test_uartPending(TEST_UART4));
+
+    /* <----------| FIRMWARE VERSION |----------> */
+
+    // Found behind more banner than the old 512 byte buffer held, up to the ':'
+    test_uartSent(TEST_UART4, sent, sizeof(sent));
+    for (i = 0; i < 60; i++) {
+        test_uartQueue(TEST_UART4, (const uint8_t *)"bl-start STR730 boot-ok\r\n", 25);
+    }
+    test_uartQueue(TEST_UART4, (const uint8_t *)"r3_robot/tags/release-3.8.3:6214 CLEAN\r\n", 41);
+    TEST_CHECK(strcmp(oi_checkFirmware(), "release-3.8.3") == 0);
+    TEST_CHECK_EQUAL(1, test_uartSent(TEST_UART4, sent, sizeof(sent)));
+    TEST_CHECK_EQUAL(TEST_OPCODE_RESET, sent[0]);
+    while (!(UART4_FR_R & UART_FR_RXFE)) { (void)UART4_DR_R; }
+
+    // No banner at all: empty, at the deadline (counted in whole milliseconds) and not much later
+    start = test_micros;
+    TEST_CHECK(strcmp(oi_checkFirmware(), "") == 0);
+    TEST_CHECK(test_micros - start >= TEST_FIRMWARE_TIMEOUT_MICROS - 1000);
+    TEST_CHECK(test_micros - start < TEST_FIRMWARE_TIMEOUT_MICROS + 50'000);
+
+    // The tag, then a version that never ends and then silence: cut at 20 characters, still terminated
+    test_uartQueue(TEST_UART4, (const uint8_t *)"r3_robot/tags/release-3.8.3-with-a-very-long-suffix", 51);
+    TEST_CHECK(strcmp(oi_checkFirmware(), "release-3.8.3-with-a") == 0);
+    while (!(UART4_FR_R & UART_FR_RXFE)) { (void)UART4_DR_R; }
+
+    // The tag and the start of the version, then silence: whatever arrived before the deadline
+    start = test_micros;
+    test_uartQueue(TEST_UART4, (const uint8_t *)"r3_robot/tags/rel", 17);
+    TEST_CHECK(strcmp(oi_checkFirmware(), "rel") == 0);
+    TEST_CHECK(test_micros - start < TEST_FIRMWARE_TIMEOUT_MICROS + 50'000);
+
+    free(sensor);
+
+    return test_report("open_interface");
+}
+
+static void test_replay(oi_t *sensor, int16_t leftTicks, int16_t rightTicks, uint16_t steps) {
+    uint8_t request[8];
+    uint8_t reply[4];
+    uint16_t i;
+
+    for (i = 0; i < steps; i++) {
+        leftCount = (int16_t)(uint16_t)(leftCount + leftTicks);
+        rightCount = (int16_t)(uint16_t)(rightCount + rightTicks);
+
+        // Packets 43 and 44, big-endian, in the order the query list asks for them
+        reply[0] = (uint8_t)((uint16_t)leftCount >> 8);
+        reply[1] = (uint8_t)leftCount;
+        reply[2] = (uint8_t)((uint16_t)rightCount >> 8);
+        reply[3] = (uint8_t)rightCount;
+        test_uartQueue(TEST_UART4, reply, sizeof(reply));
+
+        TEST_CHECK_EQUAL(OI_STATUS_OK, oi_update(sensor));
+        test_uartSent(TEST_UART4, request, sizeof(request));
+    }
+}
+
+static double test_angleError(double heading, double expected) {
+    return remainder(heading - expected, 2.0 * M_PI);
+}
+
+static void test_streamFrame(const uint8_t body[], uint8_t length, bool corrupt) {
+    uint8_t header[] = { TEST_STREAM_HEADER, length };
+    uint8_t sum = TEST_STREAM_HEADER + length;
+    uint8_t i;
+
+    for (i = 0; i < length; i++) {
+        sum += body[i];
+    }
+    sum = -sum + (corrupt ? 1 : 0);
+
+    test_uartQueue(TEST_UART4, header, sizeof(header));
+    test_uartQueue(TEST_UART4, body, length);
+    test_uartQueue(TEST_UART4, &sum, 1);
+    test_uartIdle(TEST_UART4);
+    test_interrupt(INT_UART4);
+}
+
+static void test_simulateCreate(void) {
+    uint8_t sent[64];
+    uint8_t frame[8];
+    uint16_t count, i;
+
+    // The interrupt below can read the clock too
+    if (createBusy || !createStreaming) {
+        return;
+    }
+    createBusy = true;
+
+    // Drive Direct: [145][right hi][right lo][left hi][left lo]
+    count = test_uartSent(TEST_UART4, sent, sizeof(sent));
+    for (i = 0; i + 4 < count; i++) {
+        if (sent[i] == TEST_OPCODE_DRIVE_WHEELS) {
+            createRightSpeed = (int16_t)((sent[i + 1] << 8) | sent[i + 2]);
+            createLeftSpeed = (int16_t)((sent[i + 3] << 8) | sent[i + 4]);
+            if (wheelCommands && test_micros - lastWheelMicros < minWheelGapMicros) {
+                minWheelGapMicros = test_micros - lastWheelMicros;
+            }
+            lastWheelMicros = test_micros;
+            wheelCommands++;
+            i += 4;
+        }
+    }
+
+    while ((int32_t)(test_micros - createNextFrameMicros) >= 0) {
+        createLeftTicks += createLeftSpeed * (TEST_STREAM_PERIOD_MICROS / 1e6) / TEST_MM_PER_TICK;
+        createRightTicks += createRightSpeed * (TEST_STREAM_PERIOD_MICROS / 1e6) / TEST_MM_PER_TICK;
+        leftCount = (int16_t)(uint16_t)(leftCount + (int16_t)createLeftTicks);
+        rightCount = (int16_t)(uint16_t)(rightCount + (int16_t)createRightTicks);
+        createLeftTicks -= (int16_t)createLeftTicks;
+        createRightTicks -= (int16_t)createRightTicks;
+
+        // Packets 7, 43 and 44: no bumps, then the encoder counts big-endian
+        frame[0] = 7;
+        frame[1] = 0;
+        frame[2] = 43;
+        frame[3] = (uint8_t)((uint16_t)leftCount >> 8);
+        frame[4] = (uint8_t)leftCount;
+        frame[5] = 44;
+        frame[6] = (uint8_t)((uint16_t)rightCount >> 8);
+        frame[7] = (uint8_t)rightCount;
+        test_streamFrame(frame, sizeof(frame), false);
+
+        createNextFrameMicros += TEST_STREAM_PERIOD_MICROS;
+        createFrames++;
+    }
+
+    createBusy = false;
+}
+
+static void test_timeRequests(void) {
+    uint8_t sent[16];
+
+    if (test_uartSent(TEST_UART4, sent, sizeof(sent)) && sent[0] == TEST_OPCODE_QUERY_LIST
+        && requestCount < TEST_NUM_REQUESTS) {
+        requestMicros[requestCount++] = test_micros;
+    }
+}
@@ -0,0 +1,334 @@
+/**
+ * test_ping.c
+ *
+ * Drives ping.c's Timer 3 ISR with simulated edge captures and timeouts, including a capture that straddles the
+ * 24-bit counter's wrap. Checks the fixed-point tick-to-mm conversion against the double one over every 24-bit
+ * tick count and times the two on the host. Holds the speed-of-sound model to an ideal-gas reference over 0 - 40 C
+ * and 0 - 100 % humidity, and checks the range error that leaves
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include <math.h>
+#include <time.h>
+#include "test.h"
+#include "hw_stubs.h"
+#include "ping.h"
+
+/* <----------| DEFINES |----------> */
+
+#define TEST_MAX_TICKS 0xFF'FFFF
+#define TEST_BENCH_CALLS 2'000'000
+#define TEST_TICK_SECONDS 62.5e-9
+
+/* <----------| PRIVATE GLOBALS |----------> */
+
+// Last completion handed to the callback
+static ping_status_t callbackStatus = PING_STATUS_IDLE;
+static uint32_t callbackTicks = 0;
+static uint8_t numCallbacks = 0;
+
+/* <----------| PRIVATE METHODS |----------> */
+
+static void test_pingFinished(ping_status_t status, uint32_t pulseTicks);
+
+// Latches a Timer 3B capture at the given count and raises its interrupt
+static void test_captureEdge(uint32_t count);
+
+// Lets Timer 3A run out and raises its interrupt
+static void test_timeout(void);
+
+// Largest |fixed point - double| in mm over the tick range, stepping by step
+static double test_worstConversionError(uint32_t step);
+
+// Nanoseconds per call of each conversion on this machine
+static double test_benchFixed(void);
+static double test_benchDouble(void);
+
+// Reference speed of sound in m/s: dry air and water vapor as an ideal gas mixture, with Buck's saturation pressure
+static double test_referenceSpeed(double celsius, double humidityPercent);
+
+// Echo width in ticks for a target at distanceMM when sound travels at metersPerSecond
+static uint32_t test_echoTicks(double distanceMM, double metersPerSecond);
+
+// Stands in for a user-supplied model
+static uint32_t test_constantSoundModel(int16_t deciCelsius, uint8_t humidityPercent);
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+static void test_pingFinished(ping_status_t status, uint32_t pulseTicks) {
+    callbackStatus = status;
+    callbackTicks = pulseTicks;
+    numCallbacks++;
+}
+
+static void test_captureEdge(uint32_t count) {
+    TIMER3_TBR_R = count;
+    TIMER3_MIS_R = 0b0100'0000'0000;
+    test_interrupt(INT_TIMER3B);
+    TIMER3_MIS_R = 0;
+}
+
+static void test_timeout(void) {
+    TIMER3_MIS_R = 0b0001;
+    test_interrupt(INT_TIMER3A);
+    TIMER3_MIS_R = 0;
+}
+
+static double test_worstConversionError(uint32_t step) {
+    double worst = 0.0;
+    uint32_t ticks;
+
+    for (ticks = 0; ticks <= TEST_MAX_TICKS; ticks += step) {
+        double error = fabs((double)ping_ticksToMillimeters(ticks) - ping_ticksToCentimeters(ticks) * 10.0);
+
+        if (error > worst) {
+            worst = error;
+        }
+    }
+
+    return worst;
+}
+
+static double test_benchFixed(void) {
+    struct timespec begin, end;
+    volatile uint32_t sink = 0;
+    uint32_t i;
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (i = 0; i < TEST_BENCH_CALLS; i++) {
+        sink += ping_ticksToMillimeters(i * 7);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return ((end.tv_sec - begin.tv_sec) * 1e9 + (end.tv_nsec - begin.tv_nsec)) / TEST_BENCH_CALLS;
+}
+
+static double test_benchDouble(void) {
+    struct timespec begin, end;
+    volatile uint32_t sink = 0;
+    uint32_t i;
+
+    // Same work scanAngle did with ping_read(): convert, then truncate to an integer
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (i = 0; i < TEST_BENCH_CALLS; i++) {
+        sink += (uint32_t)(ping_ticksToCentimeters(i * 7) * 10.0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return ((end.tv_sec - begin.tv_sec) * 1e9 + (end.tv_nsec - begin.tv_nsec)) / TEST_BENCH_CALLS;
+}
+
+static double test_referenceSpeed(double celsius, double humidityPercent) {
+    const double gasConstant = 8.314462;
+    const double dryMolarMass = 0.0289645;
+    const double vaporMolarMass = 0.018015;
+    double saturationPa = 611.21 * exp((18.678 - celsius / 234.5) * (celsius / (257.14 + celsius)));
+    double vaporFraction = humidityPercent / 100.0 * saturationPa / 101325.0;
+    double molarMass = (1.0 - vaporFraction) * dryMolarMass + vaporFraction * vaporMolarMass;
+
+    // Molar heat capacities in units of R: 7/2 for the diatomic dry air, 4 for the nonlinear water molecule
+    double heatCapacityP = 3.5 * (1.0 - vaporFraction) + 4.0 * vaporFraction;
+    double gamma = heatCapacityP / (heatCapacityP - 1.0);
+
+    return sqrt(gamma * gasConstant * (celsius + 273.15) / molarMass);
+}
+
+static uint32_t test_echoTicks(double distanceMM, double metersPerSecond) {
+    return (uint32_t)(2.0 * distanceMM / 1000.0 / metersPerSecond / TEST_TICK_SECONDS + 0.5);
+}
+
+static uint32_t test_constantSoundModel(int16_t deciCelsius, uint8_t humidityPercent) {
+    return 340000;
+}
+
+int main(void) {
+    uint32_t ticks = 0;
+    uint32_t start;
+    int16_t deciCelsius;
+    uint8_t humidity;
+    double worstSpeedError = 0.0;
+    double worstRangeError = 0.0;
+    double worstUncompensated = 0.0;
+
+    // Both halves of Timer 3 land in the same handler, and the timeout starts at the default 20 ms in 1 us ticks
+    ping_init();
+    TEST_CHECK(test_interrupt(INT_TIMER3A));
+    TEST_CHECK(test_interrupt(INT_TIMER3B));
+    TEST_CHECK_EQUAL(15, TIMER3_TAPR_R);
+    TEST_CHECK_EQUAL(PING_DEFAULT_TIMEOUT_MICROS - 1, TIMER3_TAILR_R);
+    TEST_CHECK_EQUAL(PING_STATUS_IDLE, ping_poll(&ticks));
+
+    /* <----------| CAPTURE |----------> */
+
+    // Start sends the 5 us trigger, then arms the timeout and edge capture and returns without waiting
+    start = test_micros;
+    ping_start();
+    TEST_CHECK_EQUAL(5, test_micros - start);
+    TEST_CHECK_EQUAL(0, GPIO_PORTB_DATA_R & 0b1000);
+    TEST_CHECK(GPIO_PORTB_AFSEL_R & 0b1000);
+    TEST_CHECK(TIMER3_CTL_R & 0b0001);
+    TEST_CHECK(TIMER3_IMR_R & 0b0100'0000'0000);
+    TEST_CHECK_EQUAL(PING_STATUS_BUSY, ping_poll(&ticks));
+
+    // A second start while the echo is in flight is ignored (no second trigger)
+    start = test_micros;
+    ping_start();
+    TEST_CHECK_EQUAL(0, test_micros - start);
+
+    // An interrupt with neither capture nor timeout pending changes nothing
+    test_interrupt(INT_TIMER3B);
+    TEST_CHECK_EQUAL(PING_STATUS_BUSY, ping_poll(&ticks));
+
+    // Rising then falling edge. The timer counts down, so the width is first minus second: 9329 ticks ~ 10 cm
+    test_captureEdge(0x80'0000);
+    TEST_CHECK_EQUAL(PING_STATUS_BUSY, ping_poll(&ticks));
+    test_captureEdge(0x80'0000 - 9329);
+    TEST_CHECK_EQUAL(PING_STATUS_DONE, ping_poll(&ticks));
+    TEST_CHECK_EQUAL(9329, ticks);
+    TEST_CHECK(!(TIMER3_CTL_R & 0b0001));
+    TEST_CHECK(!(TIMER3_IMR_R & 0b0100'0000'0000));
+
+    // The result is handed over exactly once
+    ticks = 0;
+    TEST_CHECK_EQUAL(PING_STATUS_IDLE, ping_poll(&ticks));
+    TEST_CHECK_EQUAL(0, ticks);
+
+    // Echo straddling the wrap: rising edge just above 0, falling edge after the counter reloads at 0xFFFFFF
+    ping_start();
+    test_captureEdge(0x00'0100);
+    test_captureEdge(0xFF'FF00);
+    TEST_CHECK_EQUAL(PING_STATUS_DONE, ping_poll(&ticks));
+    TEST_CHECK_EQUAL(0x200, ticks);
+
+    // Rising edge at exactly 0 and falling edge at the top of the range is one tick
+    ping_start();
+    test_captureEdge(0x00'0000);
+    test_captureEdge(0xFF'FFFF);
+    TEST_CHECK_EQUAL(PING_STATUS_DONE, ping_poll(&ticks));
+    TEST_CHECK_EQUAL(1, ticks);
+
+    /* <----------| TIMEOUT |----------> */
+
+    // Nothing comes back: Timer 3A reports no echo, with no width, and stops listening for edges
+    ping_setCallback(test_pingFinished);
+    ping_start();
+    test_timeout();
+    TEST_CHECK_EQUAL(1, numCallbacks);
+    TEST_CHECK_EQUAL(PING_STATUS_NO_ECHO, callbackStatus);
+    TEST_CHECK_EQUAL(0, callbackTicks);
+    TEST_CHECK(!(TIMER3_IMR_R & 0b0100'0000'0000));
+    TEST_CHECK_EQUAL(PING_STATUS_NO_ECHO, ping_poll(&ticks));
+    TEST_CHECK_EQUAL(0, ticks);
+
+    // Echo starts but never ends: still a timeout, and the half-captured edge doesn't leak into the next reading
+    ping_start();
+    test_captureEdge(0x40'0000);
+    test_timeout();
+    TEST_CHECK_EQUAL(PING_STATUS_NO_ECHO, ping_poll(&ticks));
+    ping_start();
+    test_captureEdge(0x30'0000);
+    test_captureEdge(0x30'0000 - 500);
+    TEST_CHECK_EQUAL(PING_STATUS_DONE, callbackStatus);
+    TEST_CHECK_EQUAL(500, callbackTicks);
+    TEST_CHECK_EQUAL(PING_STATUS_DONE, ping_poll(&ticks));
+    TEST_CHECK_EQUAL(500, ticks);
+    ping_setCallback(NULL);
+
+    // The timeout is reloaded from ping_setTimeout() on each start, and 0 is taken as the shortest one
+    ping_setTimeout(5000);
+    ping_start();
+    TEST_CHECK_EQUAL(4999, TIMER3_TAILR_R);
+    test_timeout();
+    ping_poll(&ticks);
+    ping_setTimeout(0);
+    ping_start();
+    TEST_CHECK_EQUAL(0, TIMER3_TAILR_R);
+    test_timeout();
+    ping_poll(&ticks);
+    ping_setTimeout(PING_DEFAULT_TIMEOUT_MICROS);
+
+    /* <----------| FIXED POINT |----------> */
+
+    // Every 24-bit tick count, at the default 20 C: rounding in the Q24 factor and the result stays under 1 mm
+    TEST_CHECK(test_worstConversionError(1) <= 1.0);
+    TEST_CHECK_EQUAL(0, ping_ticksToMillimeters(0));
+
+    // Still true at the ends of the compensated range, where the factor is rounded differently
+    ping_setAmbient(0, 0);
+    TEST_CHECK(test_worstConversionError(17) <= 1.0);
+    ping_setAmbient(400, 100);
+    TEST_CHECK(test_worstConversionError(17) <= 1.0);
+    ping_setAmbient(PING_DEFAULT_DECI_CELSIUS, PING_DEFAULT_HUMIDITY);
+
+    // Bits above the 24-bit counter are ignored, so a width that wrapped past 0xFFFFFF converts like its low bits
+    TEST_CHECK_EQUAL(ping_ticksToMillimeters(1234), ping_ticksToMillimeters(0x100'0000 + 1234));
+    TEST_CHECK_EQUAL(ping_ticksToMillimeters(TEST_MAX_TICKS), ping_ticksToMillimeters(0xFFFF'FFFF));
+    TEST_CHECK_EQUAL(0, ping_ticksToMillimeters(0x100'0000));
+
+    // The 9329-tick echo from above is 10 cm at 20 C
+    TEST_CHECK_EQUAL(100, ping_ticksToMillimeters(9329));
+
+    /* <----------| SOUND MODEL |----------> */
+
+    // Handbook dry-air values at 0, 20 and 40 C
+    TEST_CHECK(fabs(ping_defaultSoundModel(0, 0) / 1000.0 - 331.3) < 0.1);
+    TEST_CHECK(fabs(ping_defaultSoundModel(200, 0) / 1000.0 - 343.2) < 0.1);
+    TEST_CHECK(fabs(ping_defaultSoundModel(400, 0) / 1000.0 - 354.7) < 0.1);
+
+    // Whole range, every degree and every 10 %: within 0.15 m/s of the mixture, and humidity always speeds sound up
+    for (deciCelsius = 0; deciCelsius <= 400; deciCelsius += 10) {
+        for (humidity = 0; humidity <= 100; humidity += 10) {
+            double error = fabs(ping_defaultSoundModel(deciCelsius, humidity) / 1000.0 - test_referenceSpeed(deciCelsius / 10.0, humidity));
+
+            worstSpeedError = error > worstSpeedError ? error : worstSpeedError;
+        }
+        TEST_CHECK(ping_defaultSoundModel(deciCelsius, 100) > ping_defaultSoundModel(deciCelsius, 0));
+    }
+    TEST_CHECK(worstSpeedError < 0.15);
+
+    // Range error once the ambient is set: echoes timed at the reference speed read back within 2 mm out to 2.5 m
+    for (deciCelsius = 0; deciCelsius <= 400; deciCelsius += 50) {
+        for (humidity = 0; humidity <= 100; humidity += 50) {
+            double speed = test_referenceSpeed(deciCelsius / 10.0, humidity);
+            double distanceMM;
+
+            ping_setAmbient(deciCelsius, humidity);
+            for (distanceMM = 100.0; distanceMM <= 2500.0; distanceMM += 200.0) {
+                double error = fabs(ping_ticksToMillimeters(test_echoTicks(distanceMM, speed)) - distanceMM);
+
+                worstRangeError = error > worstRangeError ? error : worstRangeError;
+            }
+        }
+    }
+    TEST_CHECK(worstRangeError <= 2.0);
+
+    // Without compensation (left at 20 C dry) the same 2.5 m target is off by several percent at either end
+    ping_setAmbient(PING_DEFAULT_DECI_CELSIUS, PING_DEFAULT_HUMIDITY);
+    worstUncompensated = fabs(ping_ticksToMillimeters(test_echoTicks(2500.0, test_referenceSpeed(0.0, 0.0))) - 2500.0);
+    TEST_CHECK(worstUncompensated > 2500.0 * 0.03);
+    worstUncompensated = fabs(ping_ticksToMillimeters(test_echoTicks(2500.0, test_referenceSpeed(40.0, 100.0))) - 2500.0);
+    TEST_CHECK(worstUncompensated > 2500.0 * 0.03);
+    printf("ping: worst speed error %.3f m/s, worst range error %.2f mm\n", worstSpeedError, worstRangeError);
+
+    // Humidity is capped at 100 %, and the conversion follows whatever model is plugged in
+    ping_setAmbient(300, 100);
+    TEST_CHECK_EQUAL(ping_defaultSoundModel(300, 100), ping_getSpeedOfSound());
+    ping_setAmbient(300, 150);
+    TEST_CHECK_EQUAL(ping_defaultSoundModel(300, 100), ping_getSpeedOfSound());
+    ping_setSoundModel(test_constantSoundModel);
+    TEST_CHECK_EQUAL(340000, ping_getSpeedOfSound());
+    TEST_CHECK_EQUAL(1000, ping_ticksToMillimeters(test_echoTicks(1000.0, 340.0)));
+    ping_setSoundModel(NULL);
+    TEST_CHECK_EQUAL(ping_defaultSoundModel(300, 100), ping_getSpeedOfSound());
+    ping_setAmbient(PING_DEFAULT_DECI_CELSIUS, PING_DEFAULT_HUMIDITY);
+
+    // Timing is the host's, where both paths have hardware support. On the M4 the double path is soft-float calls
+    printf("ping: ticks to mm %.2f ns/call fixed point, %.2f ns/call double\n", test_benchFixed(), test_benchDouble());
+
+    return test_report("ping");
+}
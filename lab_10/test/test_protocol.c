@@ -0,0 +1,115 @@
+/**
+ * test_protocol.c
+ *
+ * Checks protocol_crc16() against the published CRC-16/CCITT-FALSE check value and a bitwise reference, and the
+ * frames protocol.c hands to uDMA byte for byte
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "protocol.h"
+#include "uart.h"
+
+/* <----------| PRIVATE GLOBALS |----------> */
+
+// Last frame handed to uart_sendBufferAsync()
+static uint8_t sentFrame[PROTOCOL_OVERHEAD + PROTOCOL_MAX_PAYLOAD];
+static size_t sentLength = 0;
+static uint8_t numSent = 0;
+
+/* <----------| PRIVATE METHODS |----------> */
+
+// One bit at a time, straight from the polynomial
+static uint16_t test_crc16Bitwise(uint16_t crc, const uint8_t data[], uint16_t length);
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+// Replaces the stub: keeps a copy of the frame, then releases the buffer like a finished transfer
+bool uart_sendBufferAsync(const uint8_t *data, size_t length, uart_txCallback_t callback) {
+    memcpy(sentFrame, data, length);
+    sentLength = length;
+    numSent++;
+    callback(data, length);
+    return true;
+}
+
+int main(void) {
+    const uint8_t check[] = "123456789";
+    uint8_t random[256];
+    uint8_t payload[PROTOCOL_MAX_PAYLOAD + 1] = { 0 };
+    scanVector vectors[2] = { { 0 } };
+    uint16_t crc, i;
+
+    // CRC-16/CCITT-FALSE catalogue check value, and the empty message leaves the seed alone
+    TEST_CHECK_EQUAL(0x29B1, protocol_crc16(0xFFFF, check, 9));
+    TEST_CHECK_EQUAL(0xFFFF, protocol_crc16(0xFFFF, check, 0));
+
+    // Byte-at-a-time form matches the bitwise one, and continuing a CRC across a split gives the same answer
+    srand(2);
+    for (i = 0; i < sizeof(random); i++) {
+        random[i] = rand();
+    }
+    for (i = 0; i <= sizeof(random); i++) {
+        TEST_CHECK_EQUAL(test_crc16Bitwise(0xFFFF, random, i), protocol_crc16(0xFFFF, random, i));
+    }
+    crc = protocol_crc16(0xFFFF, random, 100);
+    TEST_CHECK_EQUAL(protocol_crc16(0xFFFF, random, sizeof(random)), protocol_crc16(crc, random + 100, sizeof(random) - 100));
+
+    // A scan frame: header, one 3-byte record per vector, CRC over everything after the sync byte
+    vectors[0].angle = 0;
+    vectors[0].pingDistance = 45;
+    vectors[0].irDistance = 30;
+    vectors[1].angle = 2;
+    vectors[1].pingDistance = 200;
+    vectors[1].irDistance = 12;
+    protocol_sendScan(vectors, 2);
+    TEST_CHECK_EQUAL(PROTOCOL_OVERHEAD + 6, sentLength);
+    TEST_CHECK_EQUAL(PROTOCOL_SYNC, sentFrame[0]);
+    TEST_CHECK_EQUAL(PROTOCOL_VERSION, sentFrame[1]);
+    TEST_CHECK_EQUAL(PROTOCOL_MSG_SCAN, sentFrame[2]);
+    TEST_CHECK_EQUAL(0, sentFrame[3]);
+    TEST_CHECK_EQUAL(6, sentFrame[4]);
+    TEST_CHECK_EQUAL(0, sentFrame[5]);
+    TEST_CHECK(memcmp(sentFrame + 6, "\x00\x2D\x1E\x02\xC8\x0C", 6) == 0);
+    crc = protocol_crc16(0xFFFF, sentFrame + 1, PROTOCOL_HEADER_LEN - 1 + 6);
+    TEST_CHECK_EQUAL(crc & 0xFF, sentFrame[12]);
+    TEST_CHECK_EQUAL(crc >> 8, sentFrame[13]);
+
+    // Sequence numbers count up across message types, 16-bit lengths are little-endian
+    protocol_sendScanEnd(2);
+    TEST_CHECK_EQUAL(PROTOCOL_MSG_SCAN_END, sentFrame[2]);
+    TEST_CHECK_EQUAL(1, sentFrame[3]);
+    TEST_CHECK_EQUAL(2, sentFrame[6]);
+    protocol_sendFrame(0x7F, payload, PROTOCOL_MAX_PAYLOAD);
+    TEST_CHECK_EQUAL(2, sentFrame[3]);
+    TEST_CHECK_EQUAL(PROTOCOL_MAX_PAYLOAD & 0xFF, sentFrame[4]);
+    TEST_CHECK_EQUAL(PROTOCOL_MAX_PAYLOAD >> 8, sentFrame[5]);
+
+    // Oversized payloads are dropped, not truncated
+    numSent = 0;
+    protocol_sendFrame(0x7F, payload, PROTOCOL_MAX_PAYLOAD + 1);
+    TEST_CHECK_EQUAL(0, numSent);
+
+    return test_report("protocol");
+}
+
+static uint16_t test_crc16Bitwise(uint16_t crc, const uint8_t data[], uint16_t length) {
+    uint16_t i;
+    uint8_t bit;
+
+    for (i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+
+    return crc;
+}
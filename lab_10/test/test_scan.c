@@ -0,0 +1,140 @@
+/**
+ * test_scan.c
+ *
+ * Runs scanField() and scanFieldAdaptive() over a synthetic scene and compares the objects segment_findObjects()
+ * sees in each, including one narrower than the adaptive coarse step. Then checks scan_fuse() against hand-worked
+ * inverse-variance results and, over a sweep of both ranges, that the fused value never leaves the interval between
+ * the inputs and is never less certain than the better sensor
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include "test.h"
+#include "hw_stubs.h"
+#include "scan.h"
+#include "segment.h"
+
+/* <----------| DEFINES |----------> */
+
+#define TEST_NUM_SCANS 91
+#define TEST_COARSE_INCREMENT 10
+#define TEST_EMPTY_MM 1200 // Past the IR table, reads as nothing there
+
+/* <----------| PRIVATE GLOBALS |----------> */
+
+// Synthetic scene: objects as angle spans at a fixed range, nothing anywhere else
+static const struct {
+    uint8_t startAngle;
+    uint8_t endAngle;
+    uint16_t distanceMM;
+} scene[] = {
+    { 40, 70, 300 },
+    { 104, 108, 250 }, // Between the 100 and 110 degree coarse samples
+    { 140, 160, 400 },
+};
+
+static float sceneAngle = 0.0f;
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+// The scene seen from the servo's current angle, through a perfect IR sensor
+void servo_move(float degrees) { sceneAngle = degrees; }
+
+uint16_t adc_read(void) {
+    uint8_t i;
+
+    for (i = 0; i < sizeof(scene) / sizeof(scene[0]); i++) {
+        if (sceneAngle >= scene[i].startAngle && sceneAngle <= scene[i].endAngle) {
+            return scene[i].distanceMM;
+        }
+    }
+
+    return TEST_EMPTY_MM;
+}
+
+uint16_t adc_calculateIRDistanceMM(uint16_t adcCode) { return adcCode > 500 ? 500 : adcCode; }
+
+int main(void) {
+    scanVector uniform[TEST_NUM_SCANS], adaptive[TEST_NUM_SCANS];
+    segment_object_t uniformObjects[8], adaptiveObjects[8];
+    uint8_t numUniform, numAdaptive, samples;
+    uint8_t i;
+    uint32_t variance, irVariance, pingVariance;
+    uint16_t irMM, pingMM, fused;
+    uint32_t difference;
+
+    /* <----------| SYNTHETIC SCENE |----------> */
+
+    scanField(0, 180, 2, uniform);
+    samples = scanFieldAdaptive(0, 180, TEST_COARSE_INCREMENT, 2, adaptive);
+    numUniform = segment_findObjects(uniform, TEST_NUM_SCANS, uniformObjects, 8, NULL);
+    numAdaptive = segment_findObjects(adaptive, TEST_NUM_SCANS, adaptiveObjects, 8, NULL);
+    printf("scan: adaptive took %u samples instead of %u, found %u of %u objects\n", samples, TEST_NUM_SCANS,
+           numAdaptive, numUniform);
+
+    // The full-resolution scan sees every object at its true span
+    TEST_CHECK_EQUAL(3, numUniform);
+    for (i = 0; i < numUniform; i++) {
+        TEST_CHECK_EQUAL(scene[i].startAngle, uniformObjects[i].startAngle);
+        TEST_CHECK_EQUAL(scene[i].endAngle, uniformObjects[i].endAngle);
+        TEST_CHECK_EQUAL(scene[i].distanceMM, uniformObjects[i].distanceMM);
+    }
+
+    // Adaptive refines the edges of the wide objects to the same widths with far fewer samples...
+    TEST_CHECK(samples < TEST_NUM_SCANS / 2);
+    TEST_CHECK_EQUAL(2, numAdaptive);
+    TEST_CHECK_EQUAL(uniformObjects[0].widthMM, adaptiveObjects[0].widthMM);
+    TEST_CHECK_EQUAL(uniformObjects[2].widthMM, adaptiveObjects[1].widthMM);
+
+    // ...but the 4 degree object fell between two coarse samples that agreed, so it was never looked at. No parity,
+    // which is why main.c keeps scanField()
+    for (i = 52; i <= 54; i++) {
+        TEST_CHECK(adaptive[i].fusedDistance >= NO_OBJECT_DISTANCE * 10);
+    }
+    TEST_CHECK_EQUAL(250, uniform[53].fusedDistance);
+
+    /* <----------| FUSION |----------> */
+
+    // Nothing seen
+    TEST_CHECK_EQUAL(PING_NO_ECHO_MM, scan_fuse(300, false, 300, false, &variance));
+    TEST_CHECK_EQUAL(SCAN_VARIANCE_UNKNOWN, variance);
+
+    // One sensor: its own reading and model variance. IR sigma at 300 mm = 2 + 90000 / 20000 = 6
+    TEST_CHECK_EQUAL(300, scan_fuse(300, true, 0, false, &variance));
+    TEST_CHECK_EQUAL(36, variance);
+    // PING sigma at 500 mm = 10 + 500 / 100 = 15
+    TEST_CHECK_EQUAL(500, scan_fuse(0, false, 500, true, &variance));
+    TEST_CHECK_EQUAL(225, variance);
+
+    // Agreeing: (300 * 169 + 320 * 36) / 205 = 304.0, variance 36 * 169 / 205 = 29.7
+    TEST_CHECK_EQUAL(304, scan_fuse(300, true, 320, true, &variance));
+    TEST_CHECK_EQUAL(29, variance);
+    // Same range from both: unchanged value, variance 196 * 225 / 421 = 104.8
+    TEST_CHECK_EQUAL(500, scan_fuse(500, true, 500, true, &variance));
+    TEST_CHECK_EQUAL(104, variance);
+
+    // 700 mm apart is far past 3 sigma: keep the quieter IR and inflate its variance by (difference / 2)^2
+    TEST_CHECK_EQUAL(300, scan_fuse(300, true, 1000, true, &variance));
+    TEST_CHECK_EQUAL(36 + 700 * 700 / 4, variance);
+
+    // Sweep: the result stays between the inputs, and agreeing sensors beat either one alone
+    for (irMM = 50; irMM <= 800; irMM += 10) {
+        for (pingMM = 20; pingMM <= 3000; pingMM += 20) {
+            scan_fuse(irMM, true, 0, false, &irVariance);
+            scan_fuse(0, false, pingMM, true, &pingVariance);
+            fused = scan_fuse(irMM, true, pingMM, true, &variance);
+
+            TEST_CHECK(fused >= (irMM < pingMM ? irMM : pingMM) && fused <= (irMM > pingMM ? irMM : pingMM));
+            difference = irMM > pingMM ? irMM - pingMM : pingMM - irMM;
+            if (difference * difference <= 9 * (irVariance + pingVariance)) {
+                TEST_CHECK(variance <= irVariance && variance <= pingVariance);
+            }
+        }
+    }
+
+    return test_report("scan");
+}
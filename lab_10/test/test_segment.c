@@ -0,0 +1,113 @@
+/**
+ * test_segment.c
+ *
+ * Runs segment_findObjects() over a synthetic 91-point scene with one of every case it distinguishes: a plain
+ * object, a depth split, a bridged dropout, a gap too long to bridge, a lone reading and an object clipped by
+ * the end of the scan. Widths are checked against hand-worked 2 * d * sin(span / 2)
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include "test.h"
+#include "segment.h"
+
+/* <----------| DEFINES |----------> */
+
+#define TEST_NUM_VALUES 91
+#define TEST_BACKGROUND_MM 3000
+#define TEST_CONFIDENT 100
+#define TEST_NOISY 1000
+
+/* <----------| PRIVATE METHODS |----------> */
+
+// Puts an object at distanceMM over indices first..last of the scene
+static void test_place(scanVector vectors[], uint8_t first, uint8_t last, uint16_t distanceMM);
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+int main(void) {
+    scanVector vectors[TEST_NUM_VALUES];
+    segment_object_t objects[10];
+    uint8_t numObjects, numDropped, i;
+
+    for (i = 0; i < TEST_NUM_VALUES; i++) {
+        vectors[i].angle = 2 * i;
+        vectors[i].fusedDistance = TEST_BACKGROUND_MM;
+        vectors[i].fusedVariance = SCAN_VARIANCE_UNKNOWN;
+    }
+    test_place(vectors, 10, 14, 300);                      // plain object, 20-28 degrees
+    test_place(vectors, 30, 34, 200);                      // two objects touching in angle, 200 mm apart in depth
+    test_place(vectors, 35, 39, 400);
+    test_place(vectors, 50, 55, 350);                      // one dropout inside, bridged
+    vectors[52].fusedDistance = TEST_BACKGROUND_MM;
+    test_place(vectors, 60, 65, 300);                      // two dropouts in a row, split in two
+    vectors[62].fusedDistance = TEST_BACKGROUND_MM;
+    vectors[63].fusedDistance = TEST_BACKGROUND_MM;
+    test_place(vectors, 70, 70, 300);                      // single reading, too short to report
+    test_place(vectors, 88, 90, 250);                      // runs off the end of the scan
+    vectors[89].fusedVariance = TEST_NOISY;
+
+    numObjects = segment_findObjects(vectors, TEST_NUM_VALUES, objects, 10, &numDropped);
+    TEST_CHECK_EQUAL(7, numObjects);
+    TEST_CHECK_EQUAL(0, numDropped);
+
+    TEST_CHECK_EQUAL(20, objects[0].startAngle);
+    TEST_CHECK_EQUAL(28, objects[0].endAngle);
+    TEST_CHECK_EQUAL(24, objects[0].centerAngle);
+    TEST_CHECK_EQUAL(300, objects[0].distanceMM);
+    TEST_CHECK_EQUAL(42, objects[0].widthMM);              // 2 * 300 * sin(4) = 41.9
+    TEST_CHECK_EQUAL(5, objects[0].numSamples);
+    TEST_CHECK_EQUAL(100, objects[0].confidence);
+    TEST_CHECK(!objects[0].clipped);
+
+    TEST_CHECK_EQUAL(60, objects[1].startAngle);
+    TEST_CHECK_EQUAL(68, objects[1].endAngle);
+    TEST_CHECK_EQUAL(28, objects[1].widthMM);              // 2 * 200 * sin(4) = 27.9
+    TEST_CHECK_EQUAL(70, objects[2].startAngle);
+    TEST_CHECK_EQUAL(78, objects[2].endAngle);
+    TEST_CHECK_EQUAL(56, objects[2].widthMM);              // 2 * 400 * sin(4) = 55.8
+
+    TEST_CHECK_EQUAL(100, objects[3].startAngle);
+    TEST_CHECK_EQUAL(110, objects[3].endAngle);
+    TEST_CHECK_EQUAL(5, objects[3].numSamples);
+    TEST_CHECK_EQUAL(350, objects[3].distanceMM);          // center reading is the dropout, first reading used
+    TEST_CHECK_EQUAL(61, objects[3].widthMM);              // 2 * 350 * sin(5) = 61.0
+
+    TEST_CHECK_EQUAL(120, objects[4].startAngle);
+    TEST_CHECK_EQUAL(122, objects[4].endAngle);
+    TEST_CHECK_EQUAL(128, objects[5].startAngle);
+    TEST_CHECK_EQUAL(130, objects[5].endAngle);
+
+    TEST_CHECK_EQUAL(176, objects[6].startAngle);
+    TEST_CHECK_EQUAL(180, objects[6].endAngle);
+    TEST_CHECK_EQUAL(17, objects[6].widthMM);              // 2 * 250 * sin(2) = 17.4
+    TEST_CHECK(objects[6].clipped);
+    TEST_CHECK_EQUAL(33, objects[6].confidence);           // 2 of 3 confident = 66, halved for clipping
+
+    // Objects past maxObjects are counted, not written
+    numObjects = segment_findObjects(vectors, TEST_NUM_VALUES, objects, 2, &numDropped);
+    TEST_CHECK_EQUAL(2, numObjects);
+    TEST_CHECK_EQUAL(5, numDropped);
+    TEST_CHECK_EQUAL(60, objects[1].startAngle);
+
+    // Empty field
+    for (i = 0; i < TEST_NUM_VALUES; i++) {
+        vectors[i].fusedDistance = TEST_BACKGROUND_MM;
+    }
+    TEST_CHECK_EQUAL(0, segment_findObjects(vectors, TEST_NUM_VALUES, objects, 10, NULL));
+
+    return test_report("segment");
+}
+
+static void test_place(scanVector vectors[], uint8_t first, uint8_t last, uint16_t distanceMM) {
+    uint8_t i;
+
+    for (i = first; i <= last; i++) {
+        vectors[i].fusedDistance = distanceMM;
+        vectors[i].fusedVariance = TEST_CONFIDENT;
+    }
+}
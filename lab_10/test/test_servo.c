@@ -0,0 +1,252 @@
+/**
+ * test_servo.c
+ *
+ * Checks servo.c's settle-time model and what it does to a full scanField() sweep, which used to wait a flat
+ * 100 ms at every step, then checks the angle estimate against a simulated horn that follows the pulse width
+ * SERVO_DEFAULT_SETTLE_BASE_MILLIS late and slew-limited
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include "test.h"
+#include "hw_stubs.h"
+#include "scan.h"
+#include "servo.h"
+
+/* <----------| DEFINES |----------> */
+
+#define TEST_RIGHT_BOUND 49295
+#define TEST_LEFT_BOUND 21764
+#define TEST_OLD_SETTLE_MILLIS 100 // What servo_move() used to wait at every step
+#define TEST_SIM_STEP_MICROS 10     // Integration step of the simulated horn
+#define TEST_SIM_LOG_LEN 64         // Match register changes remembered by the simulation, power of two
+
+/* <----------| PRIVATE GLOBALS |----------> */
+
+uint16_t servo_rightBound = TEST_RIGHT_BOUND;
+uint16_t servo_leftBound = TEST_LEFT_BOUND;
+
+// Simulated horn: the match register values it has been given, when, and where that has put it
+static struct {
+    uint32_t micros;
+    float degrees;
+} simCommands[TEST_SIM_LOG_LEN];
+static uint8_t simNewest = 0;
+static uint32_t simMicros = 0;
+static float simHornDegrees = 0.0f;
+static float simMaxLead = 0.0f; // Largest amount the commanded angle ran ahead of the horn
+
+// Horn angles at each adc_read(), so a sweep's angle tags can be checked against where the horn really was
+static float captureDegrees[91];
+static uint8_t captureCount = 0;
+
+/* <----------| PRIVATE METHODS |----------> */
+
+// Angle the match register currently asks for
+static float test_commandedDegrees(void);
+
+// test_onAdvance hook: records new commands and moves the horn up to test_micros
+static void test_simulateServo(void);
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+// Samples the simulated horn instead of an IR sensor
+uint16_t adc_read(void) {
+    if (captureCount < 91) {
+        captureDegrees[captureCount++] = simHornDegrees;
+    }
+
+    return (uint16_t)(simHornDegrees * 10 + 0.5f);
+}
+
+uint16_t adc_calculateIRDistanceMM(uint16_t adcCode) { return adcCode; }
+
+static float test_commandedDegrees(void) {
+    return ((float)(TIMER1_TBMATCHR_R & 0xFFFF) - TEST_LEFT_BOUND) * 180.0f / (TEST_RIGHT_BOUND - TEST_LEFT_BOUND);
+}
+
+static void test_simulateServo(void) {
+    float commanded = test_commandedDegrees();
+    float target, step;
+    uint8_t age;
+
+    // The write happened some time since the last advance; take the earliest it could have been
+    if (commanded != simCommands[simNewest].degrees) {
+        simNewest = (simNewest + 1) & (TEST_SIM_LOG_LEN - 1);
+        simCommands[simNewest].micros = simMicros;
+        simCommands[simNewest].degrees = commanded;
+    }
+
+    while (simMicros < test_micros) {
+        simMicros += TEST_SIM_STEP_MICROS;
+
+        // Pure dead time: the horn heads for whatever was commanded the settle base ago
+        for (age = 0; age < TEST_SIM_LOG_LEN - 1; age++) {
+            if (simCommands[(simNewest - age) & (TEST_SIM_LOG_LEN - 1)].micros + SERVO_DEFAULT_SETTLE_BASE_MILLIS * 1000
+                <= simMicros) {
+                break;
+            }
+        }
+        target = simCommands[(simNewest - age) & (TEST_SIM_LOG_LEN - 1)].degrees;
+
+        // Slew limited
+        step = (float)TEST_SIM_STEP_MICROS / SERVO_DEFAULT_MICROS_PER_DEGREE;
+        if (target > simHornDegrees + step) {
+            simHornDegrees += step;
+        } else if (target < simHornDegrees - step) {
+            simHornDegrees -= step;
+        } else {
+            simHornDegrees = target;
+        }
+
+        if (commanded - simHornDegrees > simMaxLead) {
+            simMaxLead = commanded - simHornDegrees;
+        }
+    }
+}
+
+int main(void) {
+    scanVector vectors[91];
+    uint32_t start, sweepMillis;
+    float error, maxError;
+    uint8_t count, i;
+
+    servo_init();
+
+    /* <----------| SETTLE MODEL |----------> */
+
+    // 15 ms of fixed overhead plus 3.2 ms per degree, rounded up to the next whole millisecond
+    TEST_CHECK_EQUAL(15, servo_settleMillis(0.0f));
+    TEST_CHECK_EQUAL(22, servo_settleMillis(2.0f));
+    TEST_CHECK_EQUAL(47, servo_settleMillis(10.0f));
+    TEST_CHECK_EQUAL(303, servo_settleMillis(90.0f));
+    TEST_CHECK_EQUAL(591, servo_settleMillis(180.0f));
+
+    // Direction doesn't matter, and nothing takes longer than a full swing
+    TEST_CHECK_EQUAL(servo_settleMillis(10.0f), servo_settleMillis(-10.0f));
+    TEST_CHECK_EQUAL(591, servo_settleMillis(400.0f));
+
+    // A different servo: its own overhead and slew rate
+    servo_setSlewModel(30, 1000);
+    TEST_CHECK_EQUAL(40, servo_settleMillis(10.0f));
+    TEST_CHECK_EQUAL(31, servo_settleMillis(0.5f));
+    servo_setSlewModel(SERVO_DEFAULT_SETTLE_BASE_MILLIS, SERVO_DEFAULT_MICROS_PER_DEGREE);
+
+    /* <----------| MOVES |----------> */
+
+    // The match register maps 0 - 180 degrees onto the calibrated bounds
+    servo_moveAsync(0.0f);
+    TEST_CHECK_EQUAL(TEST_LEFT_BOUND, TIMER1_TBMATCHR_R & 0xFFFF);
+    servo_moveAsync(180.0f);
+    TEST_CHECK_EQUAL(TEST_RIGHT_BOUND, TIMER1_TBMATCHR_R & 0xFFFF);
+    servo_moveAsync(90.0f);
+    TEST_CHECK_EQUAL(TEST_LEFT_BOUND + (TEST_RIGHT_BOUND - TEST_LEFT_BOUND) / 2, TIMER1_TBMATCHR_R & 0xFFFF);
+    test_advance(1'000'000);
+    TEST_CHECK(servo_isSettled());
+
+    // An async move returns at once and is settled exactly when the model says: 10 degrees is 47 ms
+    start = test_micros;
+    servo_moveAsync(100.0f);
+    TEST_CHECK_EQUAL(start, test_micros);
+    TEST_CHECK(!servo_isSettled());
+    test_advance(46'999);
+    TEST_CHECK(!servo_isSettled());
+    test_advance(1'000);
+    TEST_CHECK(servo_isSettled());
+
+    // servo_move() blocks for that long and no longer
+    test_clockStep = 10;
+    start = test_micros;
+    servo_move(102.0f);
+    TEST_CHECK((test_micros - start) / 1000 == 22);
+    start = test_micros;
+    servo_move(12.0f);
+    TEST_CHECK((test_micros - start) / 1000 == 303);
+
+    /* <----------| SWEEP |----------> */
+
+    // A full 0 - 180 scanField() at 2 degrees: one swing back to the start, then 90 short steps of 22 ms each
+    servo_move(180.0f);
+    start = test_micros;
+    scanField(0, 180, 2, vectors);
+    sweepMillis = (test_micros - start) / 1000;
+    printf("servo: 91-point sweep %u ms, was %u ms at %u ms per step\n", (unsigned int)sweepMillis,
+           91 * TEST_OLD_SETTLE_MILLIS, TEST_OLD_SETTLE_MILLIS);
+    TEST_CHECK(sweepMillis >= 591 + 90 * 22);
+    TEST_CHECK(sweepMillis < 591 + 90 * 22 + 20);
+    TEST_CHECK(sweepMillis * 3 < 91 * TEST_OLD_SETTLE_MILLIS);
+    TEST_CHECK_EQUAL(180, vectors[90].angle);
+
+    // Time stamps in the vectors follow the same model: 22 ms apart after the first point
+    TEST_CHECK_EQUAL(22, vectors[46].timeMillis - vectors[45].timeMillis);
+
+    /* <----------| KINEMATICS |----------> */
+
+    // From here on a simulated horn follows the pulse width, starting at rest where scanField() left it
+    servo_move(0.0f);
+    simMicros = test_micros;
+    simHornDegrees = test_commandedDegrees();
+    for (i = 0; i < TEST_SIM_LOG_LEN; i++) {
+        simCommands[i].micros = test_micros;
+        simCommands[i].degrees = simHornDegrees;
+    }
+    test_onAdvance = test_simulateServo;
+    test_advance(100'000);
+
+    // A step: the estimate sits still through the dead time along with the horn, then tracks it all the way over
+    servo_moveAsync(90.0f);
+    test_advance(10'000);
+    TEST_CHECK(servo_getEstimatedAngle() < 0.01f);
+    TEST_CHECK(simHornDegrees < 0.01f);
+    maxError = 0.0f;
+    while (!servo_isSettled()) {
+        test_advance(1'000);
+        error = servo_getEstimatedAngle() - simHornDegrees;
+        if (error < 0) { error = -error; }
+        if (error > maxError) { maxError = error; }
+    }
+    TEST_CHECK(maxError < 0.05f);
+    TEST_CHECK(simHornDegrees > 89.95f);
+
+    // Redirected mid-swing: the new move starts from where the commanded path had got to, not the lagging horn
+    servo_moveAsync(180.0f);
+    test_advance(100'000);
+    servo_moveAsync(30.0f);
+    maxError = 0.0f;
+    for (i = 0; i < 200; i++) {
+        test_advance(2'000);
+        error = servo_getEstimatedAngle() - simHornDegrees;
+        if (error < 0) { error = -error; }
+        if (error > maxError) { maxError = error; }
+    }
+    TEST_CHECK(maxError < 0.05f);
+    TEST_CHECK(servo_isSettled());
+    TEST_CHECK(simHornDegrees < 30.05f);
+
+    // A continuous sweep runs the setpoint ~1.8 degrees ahead of the horn. Every angle tag has to land on where the
+    // horn was when it was read, give or take the rounding to whole degrees
+    captureCount = 0;
+    simMaxLead = 0.0f;
+    start = test_micros;
+    count = scanFieldContinuous(0, 180, 2, vectors);
+    sweepMillis = (test_micros - start) / 1000;
+    printf("servo: 91-point continuous sweep %u ms, setpoint led the horn by up to %.2f degrees\n",
+           (unsigned int)sweepMillis, simMaxLead);
+    TEST_CHECK_EQUAL(91, count);
+    TEST_CHECK_EQUAL(91, captureCount);
+    TEST_CHECK(simMaxLead > 1.5f);
+    maxError = 0.0f;
+    for (i = 0; i < count; i++) {
+        error = vectors[i].angle - captureDegrees[i];
+        if (error < 0) { error = -error; }
+        if (error > maxError) { maxError = error; }
+    }
+    TEST_CHECK(maxError < 0.6f);
+    test_onAdvance = NULL;
+
+    return test_report("servo");
+}
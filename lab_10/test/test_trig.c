@@ -0,0 +1,59 @@
+/**
+ * test_trig.c
+ *
+ * Checks the Q15 sine table against libm over several full turns, and trig_chord() against its documented bound
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include <math.h>
+#include "test.h"
+#include "trig.h"
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+int main(void) {
+    const uint16_t radii[] = { 0, 1, 100, 500, 1000, 3000, 10000, 32767 };
+    int32_t halfDegrees;
+    uint8_t i;
+    int span;
+
+    // Known points, including the fold at every quadrant
+    TEST_CHECK_EQUAL(0, trig_sinQ15(0));
+    TEST_CHECK_EQUAL(16384, trig_sinQ15(60));
+    TEST_CHECK_EQUAL(32767, trig_sinQ15(180));
+    TEST_CHECK_EQUAL(0, trig_sinQ15(360));
+    TEST_CHECK_EQUAL(-32767, trig_sinQ15(540));
+    TEST_CHECK_EQUAL(-16384, trig_sinQ15(-60));
+    TEST_CHECK_EQUAL(32767, trig_cosQ15(0));
+    TEST_CHECK_EQUAL(16384, trig_cosQ15(120));
+
+    // Every half degree over three turns, negative angles included, within 1 LSB of round(32768 * sin) capped
+    for (halfDegrees = -TRIG_FULL_TURN; halfDegrees <= 2 * TRIG_FULL_TURN; halfDegrees++) {
+        double expected = round(32768.0 * sin(halfDegrees * M_PI / 360.0));
+        if (expected > 32767.0) { expected = 32767.0; }
+        if (expected < -32767.0) { expected = -32767.0; }
+        TEST_CHECK(fabs(trig_sinQ15(halfDegrees) - expected) <= 1.0);
+        TEST_CHECK(fabs(trig_cosQ15(halfDegrees) - round(32767.0 * cos(halfDegrees * M_PI / 360.0))) <= 1.0);
+    }
+
+    // Chord error at most 0.5 + radius / 16384 for every span, up to the largest radius whose chord fits 16 bits
+    for (i = 0; i < sizeof(radii) / sizeof(radii[0]); i++) {
+        for (span = 0; span <= 180; span++) {
+            double expected = 2.0 * radii[i] * sin(span * M_PI / 360.0);
+            TEST_CHECK(fabs(trig_chord(radii[i], span) - expected) <= 0.5 + radii[i] / 16384.0);
+        }
+    }
+    TEST_CHECK_EQUAL(1000, trig_chord(1000, 60));
+    TEST_CHECK_EQUAL(0, trig_chord(1000, 0));
+
+    // Longer chords saturate instead of wrapping
+    TEST_CHECK_EQUAL(UINT16_MAX, trig_chord(65535, 180));
+    TEST_CHECK_EQUAL(UINT16_MAX, trig_chord(40000, 120));
+
+    return test_report("trig");
+}
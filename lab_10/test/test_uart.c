@@ -0,0 +1,274 @@
+/**
+ * test_uart.c
+ *
+ * Runs uart.c's ring buffers and ISR against the fake UART1: how many bytes each interrupt moves in either
+ * direction, what happens when the RX ring fills, and that the TX ring keeps bytes in order when it is full.
+ * Then hands uart_sendBufferAsync() buffers to the fake uDMA controller to check who owns each of the two slots
+ *
+ * @date November 30, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include <string.h>
+#include "test.h"
+#include "hw_stubs.h"
+#include "dma.h"
+#include "uart.h"
+
+/* <----------| PRIVATE GLOBALS |----------> */
+
+volatile char uart_data;
+volatile char flag;
+
+// uart_sendBufferAsync() completions, in order
+static const uint8_t *finishedData[4];
+static size_t finishedLength[4];
+static uint8_t numFinished = 0;
+
+/* <----------| PRIVATE METHODS |----------> */
+
+static void test_bufferFinished(const uint8_t *data, size_t length);
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+static void test_bufferFinished(const uint8_t *data, size_t length) {
+    finishedData[numFinished] = data;
+    finishedLength[numFinished] = length;
+    numFinished++;
+}
+
+int main(void) {
+    static uint8_t large[2500];
+    static uint8_t sent[4096];
+    uint8_t data[300];
+    uint8_t small[100];
+    uart_stats_t before, after;
+    uint16_t i;
+
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 7 + 1);
+    }
+    for (i = 0; i < sizeof(large); i++) {
+        large[i] = (uint8_t)(i * 13 + 5);
+    }
+    memset(small, 0xA5, sizeof(small));
+
+    // 115200 baud from the 16 MHz clock is 8 + 44/64, and the ISR is live straight away for RX and RX timeout
+    uart_init(115200);
+    TEST_CHECK_EQUAL(8, UART1_IBRD_R);
+    TEST_CHECK_EQUAL(44, UART1_FBRD_R);
+    TEST_CHECK_EQUAL(UART_IM_RXIM | UART_IM_RTIM, UART1_IM_R);
+    TEST_CHECK(!test_interruptsMasked());
+
+    /* <----------| RX |----------> */
+
+    // Below the 1/2-full threshold nothing is raised until the line goes quiet, then one interrupt takes them all
+    before = uart_getStats();
+    test_uartQueue(TEST_UART1, data, 3);
+    TEST_CHECK_EQUAL(0, UART1_MIS_R);
+    test_uartIdle(TEST_UART1);
+    TEST_CHECK_EQUAL(UART_MIS_RTMIS, UART1_MIS_R);
+    TEST_CHECK(test_interrupt(INT_UART1));
+    after = uart_getStats();
+    TEST_CHECK_EQUAL(1, after.interrupts - before.interrupts);
+    TEST_CHECK_EQUAL(3, after.rxBytes - before.rxBytes);
+    TEST_CHECK_EQUAL(0, test_uartPending(TEST_UART1));
+    for (i = 0; i < 3; i++) {
+        TEST_CHECK_EQUAL(data[i], (uint8_t)uart_getChar());
+    }
+    TEST_CHECK_EQUAL(data[2], (uint8_t)uart_data);
+
+    // A burst interrupts once per 8 bytes (the RX threshold), not once per byte
+    before = uart_getStats();
+    for (i = 0; i < 6; i++) {
+        test_uartQueue(TEST_UART1, data + i * 8, 8);
+        TEST_CHECK_EQUAL(UART_MIS_RXMIS, UART1_MIS_R);
+        TEST_CHECK(test_interrupt(INT_UART1));
+    }
+    after = uart_getStats();
+    TEST_CHECK_EQUAL(6, after.interrupts - before.interrupts);
+    TEST_CHECK_EQUAL(48, after.rxBytes - before.rxBytes);
+    for (i = 0; i < 48; i++) {
+        TEST_CHECK_EQUAL(data[i], (uint8_t)uart_getChar());
+    }
+
+    // Nobody reading: the 64-byte ring fills, then newer bytes are counted as overflows and dropped
+    before = uart_getStats();
+    for (i = 0; i < 10; i++) {
+        test_uartQueue(TEST_UART1, data + i * 8, 8);
+        TEST_CHECK(test_interrupt(INT_UART1));
+    }
+    after = uart_getStats();
+    TEST_CHECK_EQUAL(64, after.rxBytes - before.rxBytes);
+    TEST_CHECK_EQUAL(16, after.rxOverflows - before.rxOverflows);
+    TEST_CHECK_EQUAL(0, test_uartPending(TEST_UART1));
+    for (i = 0; i < 64; i++) {
+        TEST_CHECK_EQUAL(data[i], (uint8_t)uart_getChar());
+    }
+
+    // Room again once main has caught up
+    test_uartQueue(TEST_UART1, data + 100, 8);
+    TEST_CHECK(test_interrupt(INT_UART1));
+    for (i = 0; i < 8; i++) {
+        TEST_CHECK_EQUAL(data[100 + i], (uint8_t)uart_getChar());
+    }
+    TEST_CHECK_EQUAL(16, uart_getStats().rxOverflows - before.rxOverflows);
+
+    /* <----------| TX |----------> */
+
+    // Idle line: everything goes straight into the FIFO and the TX interrupt is never armed
+    uart_sendStr("hi");
+    TEST_CHECK_EQUAL(2, test_uartSent(TEST_UART1, sent, sizeof(sent)));
+    TEST_CHECK(memcmp(sent, "hi", 2) == 0);
+    TEST_CHECK(!(UART1_IM_R & UART_IM_TXIM));
+
+    // Slow line: the first 16 fill the FIFO, the rest wait in the ring behind the TX interrupt
+    test_uartHoldTx(TEST_UART1, true);
+    before = uart_getStats();
+    for (i = 0; i < 40; i++) {
+        uart_sendChar((char)data[i]);
+    }
+    TEST_CHECK_EQUAL(16, test_uartTxLevel(TEST_UART1));
+    TEST_CHECK_EQUAL(16, uart_getStats().txBytes - before.txBytes);
+    TEST_CHECK(UART1_IM_R & UART_IM_TXIM);
+    TEST_CHECK_EQUAL(0, UART1_MIS_R & UART_MIS_TXMIS);
+
+    // Each time the FIFO drains to 1/8 the ISR tops it back up in one go: 14 bytes per interrupt
+    before = uart_getStats();
+    TEST_CHECK_EQUAL(14, test_uartShiftOut(TEST_UART1, 14));
+    TEST_CHECK_EQUAL(UART_MIS_TXMIS, UART1_MIS_R);
+    TEST_CHECK(test_interrupt(INT_UART1));
+    TEST_CHECK_EQUAL(16, test_uartTxLevel(TEST_UART1));
+    TEST_CHECK_EQUAL(14, uart_getStats().txBytes - before.txBytes);
+
+    // The last 10 empty the ring, and the ISR masks TX again so it is not raised forever
+    TEST_CHECK_EQUAL(14, test_uartShiftOut(TEST_UART1, 14));
+    TEST_CHECK(test_interrupt(INT_UART1));
+    after = uart_getStats();
+    TEST_CHECK_EQUAL(2, after.interrupts - before.interrupts);
+    TEST_CHECK_EQUAL(24, after.txBytes - before.txBytes);
+    TEST_CHECK(!(UART1_IM_R & UART_IM_TXIM));
+    TEST_CHECK_EQUAL(40, test_uartSent(TEST_UART1, sent, sizeof(sent)));
+    TEST_CHECK(memcmp(sent, data, 40) == 0);
+
+    // Full FIFO plus a full 256-byte ring is accepted without blocking, and drains in order
+    test_uartShiftOut(TEST_UART1, TEST_UART_FIFO_DEPTH);
+    for (i = 0; i < 16 + 256; i++) {
+        uart_sendChar((char)data[i]);
+    }
+    TEST_CHECK_EQUAL(16, test_uartTxLevel(TEST_UART1));
+    before = uart_getStats();
+    while (UART1_IM_R & UART_IM_TXIM) {
+        test_uartShiftOut(TEST_UART1, TEST_UART_FIFO_DEPTH);
+        TEST_CHECK(test_interrupt(INT_UART1));
+    }
+    after = uart_getStats();
+    TEST_CHECK_EQUAL(256, after.txBytes - before.txBytes);
+    TEST_CHECK_EQUAL(16, after.interrupts - before.interrupts);
+    TEST_CHECK_EQUAL(272, test_uartSent(TEST_UART1, sent, sizeof(sent)));
+    TEST_CHECK(memcmp(sent, data, 272) == 0);
+    test_uartHoldTx(TEST_UART1, false);
+
+    // RX and TX in the same interrupt: both are serviced
+    test_uartHoldTx(TEST_UART1, true);
+    for (i = 0; i < 20; i++) {
+        uart_sendChar((char)data[i]);
+    }
+    test_uartShiftOut(TEST_UART1, TEST_UART_FIFO_DEPTH);
+    test_uartQueue(TEST_UART1, data + 200, 8);
+    TEST_CHECK_EQUAL(UART_MIS_RXMIS | UART_MIS_TXMIS, UART1_MIS_R);
+    TEST_CHECK(test_interrupt(INT_UART1));
+    TEST_CHECK_EQUAL(4, test_uartTxLevel(TEST_UART1));
+    TEST_CHECK(!(UART1_IM_R & UART_IM_TXIM));
+    for (i = 0; i < 8; i++) {
+        TEST_CHECK_EQUAL(data[200 + i], (uint8_t)uart_getChar());
+    }
+    TEST_CHECK_EQUAL(20, test_uartSent(TEST_UART1, sent, sizeof(sent)));
+    TEST_CHECK(memcmp(sent, data, 20) == 0);
+    test_uartHoldTx(TEST_UART1, false);
+
+    /* <----------| uDMA |----------> */
+
+    // Nothing to send is refused outright
+    TEST_CHECK(!uart_sendBufferAsync(large, 0, test_bufferFinished));
+    TEST_CHECK_EQUAL(0, uart_pendingBuffers());
+
+    // First buffer takes slot 0 and starts on the first 1024 bytes, with interrupts left as they were
+    TEST_CHECK(uart_sendBufferAsync(large, sizeof(large), test_bufferFinished));
+    TEST_CHECK(!test_interruptsMasked());
+    TEST_CHECK_EQUAL(1, uart_pendingBuffers());
+    TEST_CHECK(dma_isChannelEnabled(DMA_CHANNEL_UART1_TX));
+    TEST_CHECK_EQUAL(DMA_MAX_TRANSFER, dma_getRemaining(DMA_CHANNEL_UART1_TX, false));
+    TEST_CHECK(test_dma[DMA_CHANNEL_UART1_TX].primary.source == large);
+
+    // Second queues in slot 1 without touching the channel, a third is refused while both are taken
+    TEST_CHECK(uart_sendBufferAsync(small, sizeof(small), test_bufferFinished));
+    TEST_CHECK_EQUAL(2, uart_pendingBuffers());
+    TEST_CHECK(!uart_sendBufferAsync(data, 10, test_bufferFinished));
+    TEST_CHECK_EQUAL(2, uart_pendingBuffers());
+    TEST_CHECK_EQUAL(DMA_MAX_TRANSFER, dma_getRemaining(DMA_CHANNEL_UART1_TX, false));
+
+    // Bytes from uart_sendChar wait in the ring while the controller owns the FIFO
+    uart_sendChar('!');
+    TEST_CHECK(!(UART1_IM_R & UART_IM_TXIM));
+
+    // Each finished chunk raises UART1's vector. The ISR clears the completion and programs the next 1024, then the 452
+    before = uart_getStats();
+    TEST_CHECK_EQUAL(DMA_MAX_TRANSFER, test_dmaRun(DMA_CHANNEL_UART1_TX, 2000));
+    TEST_CHECK(test_dma[DMA_CHANNEL_UART1_TX].completed);
+    TEST_CHECK(test_interrupt(INT_UART1));
+    TEST_CHECK(!test_dma[DMA_CHANNEL_UART1_TX].completed);
+    TEST_CHECK(test_dma[DMA_CHANNEL_UART1_TX].primary.source == large + DMA_MAX_TRANSFER);
+    TEST_CHECK_EQUAL(DMA_MAX_TRANSFER, test_dmaRun(DMA_CHANNEL_UART1_TX, 2000));
+    TEST_CHECK(test_interrupt(INT_UART1));
+    TEST_CHECK_EQUAL(sizeof(large) - 2 * DMA_MAX_TRANSFER, dma_getRemaining(DMA_CHANNEL_UART1_TX, false));
+    TEST_CHECK_EQUAL(0, numFinished);
+    TEST_CHECK_EQUAL(2, uart_pendingBuffers());
+
+    // Last chunk done: slot 0 is handed back through the callback and slot 1 moves up and starts
+    TEST_CHECK_EQUAL(sizeof(large) - 2 * DMA_MAX_TRANSFER, test_dmaRun(DMA_CHANNEL_UART1_TX, 2000));
+    TEST_CHECK(test_interrupt(INT_UART1));
+    TEST_CHECK_EQUAL(1, numFinished);
+    TEST_CHECK(finishedData[0] == large);
+    TEST_CHECK_EQUAL(sizeof(large), finishedLength[0]);
+    TEST_CHECK_EQUAL(1, uart_pendingBuffers());
+    TEST_CHECK(test_dma[DMA_CHANNEL_UART1_TX].primary.source == small);
+    TEST_CHECK_EQUAL(sizeof(small), dma_getRemaining(DMA_CHANNEL_UART1_TX, false));
+    TEST_CHECK_EQUAL(sizeof(large), uart_getStats().txBytes - before.txBytes);
+
+    // The freed slot can be reused straight away
+    TEST_CHECK(uart_sendBufferAsync(data, 10, test_bufferFinished));
+    TEST_CHECK_EQUAL(2, uart_pendingBuffers());
+
+    // Draining the rest frees both slots in order, then the waiting '!' follows the buffers out
+    TEST_CHECK_EQUAL(sizeof(small), test_dmaRun(DMA_CHANNEL_UART1_TX, 2000));
+    TEST_CHECK(test_interrupt(INT_UART1));
+    TEST_CHECK_EQUAL(10, test_dmaRun(DMA_CHANNEL_UART1_TX, 2000));
+    TEST_CHECK(test_interrupt(INT_UART1));
+    TEST_CHECK_EQUAL(3, numFinished);
+    TEST_CHECK(finishedData[1] == small);
+    TEST_CHECK(finishedData[2] == data);
+    TEST_CHECK_EQUAL(0, uart_pendingBuffers());
+    TEST_CHECK(!dma_isChannelEnabled(DMA_CHANNEL_UART1_TX));
+
+    // What left the UART is every buffer byte for byte, then the character queued behind them
+    TEST_CHECK_EQUAL(sizeof(large) + sizeof(small) + 10 + 1, test_uartSent(TEST_UART1, sent, sizeof(sent)));
+    TEST_CHECK(memcmp(sent, large, sizeof(large)) == 0);
+    TEST_CHECK(memcmp(sent + sizeof(large), small, sizeof(small)) == 0);
+    TEST_CHECK(memcmp(sent + sizeof(large) + sizeof(small), data, 10) == 0);
+    TEST_CHECK_EQUAL('!', sent[sizeof(large) + sizeof(small) + 10]);
+
+    // Called with interrupts already masked, it leaves them masked
+    IntMasterDisable();
+    TEST_CHECK(uart_sendBufferAsync(small, sizeof(small), NULL));
+    TEST_CHECK(test_interruptsMasked());
+    IntMasterEnable();
+    test_dmaRun(DMA_CHANNEL_UART1_TX, 2000);
+    TEST_CHECK(test_interrupt(INT_UART1));
+    TEST_CHECK_EQUAL(0, uart_pendingBuffers());
+
+    return test_report("uart");
+}
@@ -0,0 +1,69 @@
+/**
+ * trig.c
+ *
+ * Contains integer sine/cosine backed by a compile-time table
+ * 
+ * @date November 25, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+/* <----------| INCLUDES |----------> */
+
+#include "trig.h"
+
+/* <----------| DEFINES |----------> */
+
+#define TRIG_QUARTER_TURN (TRIG_FULL_TURN / 4)
+
+/* <----------| PRIVATE GLOBALS |----------> */
+
+// sin(i / 2 degrees) in Q15 for i = 0..180 (0 to 90 degrees), round(32768 * sin) capped at 32767
+static const int16_t SIN_TABLE[TRIG_QUARTER_TURN + 1] = {
+        0,   286,   572,   858,  1144,  1429,  1715,  2000,  2286,  2571,
+     2856,  3141,  3425,  3709,  3993,  4277,  4560,  4843,  5126,  5408,
+     5690,  5971,  6252,  6533,  6813,  7092,  7371,  7650,  7927,  8204,
+     8481,  8757,  9032,  9307,  9580,  9854, 10126, 10397, 10668, 10938,
+    11207, 11476, 11743, 12010, 12275, 12540, 12803, 13066, 13328, 13589,
+    13848, 14107, 14365, 14621, 14876, 15131, 15384, 15636, 15886, 16136,
+    16384, 16631, 16877, 17121, 17364, 17606, 17847, 18086, 18324, 18560,
+    18795, 19028, 19261, 19491, 19720, 19948, 20174, 20399, 20622, 20843,
+    21063, 21281, 21498, 21713, 21926, 22138, 22348, 22556, 22763, 22967,
+    23170, 23372, 23571, 23769, 23965, 24159, 24351, 24542, 24730, 24917,
+    25102, 25285, 25466, 25645, 25822, 25997, 26170, 26341, 26510, 26677,
+    26842, 27005, 27166, 27325, 27482, 27636, 27789, 27939, 28088, 28234,
+    28378, 28520, 28660, 28797, 28932, 29066, 29197, 29325, 29452, 29576,
+    29698, 29818, 29935, 30050, 30163, 30274, 30382, 30488, 30592, 30693,
+    30792, 30888, 30983, 31075, 31164, 31251, 31336, 31419, 31499, 31576,
+    31651, 31724, 31795, 31863, 31928, 31991, 32052, 32110, 32166, 32219,
+    32270, 32319, 32365, 32408, 32449, 32488, 32524, 32557, 32588, 32617,
+    32643, 32667, 32688, 32707, 32723, 32737, 32748, 32757, 32763, 32767,
+    32767
+};
+
+/* <----------| IMPLEMENTATIONS |----------> */
+
+int16_t trig_sinQ15(int32_t halfDegrees) {
+    int32_t angle = halfDegrees % TRIG_FULL_TURN;
+    if (angle < 0) { angle += TRIG_FULL_TURN; }
+
+    // Fold the other three quadrants onto the 0-90 degree table
+    if (angle <= TRIG_QUARTER_TURN) { return SIN_TABLE[angle]; }
+    if (angle <= 2 * TRIG_QUARTER_TURN) { return SIN_TABLE[2 * TRIG_QUARTER_TURN - angle]; }
+    if (angle <= 3 * TRIG_QUARTER_TURN) { return -SIN_TABLE[angle - 2 * TRIG_QUARTER_TURN]; }
+    return -SIN_TABLE[TRIG_FULL_TURN - angle];
+}
+
+int16_t trig_cosQ15(int32_t halfDegrees) {
+    return trig_sinQ15(halfDegrees + TRIG_QUARTER_TURN);
+}
+
+uint16_t trig_chord(uint16_t radius, uint8_t spanDegrees) {
+    if (spanDegrees > 180) { spanDegrees = 180; }
+
+    // sin(span / 2) is simply the table entry at span half degrees; 2 * r * s / 2^15 == r * s / 2^14
+    uint32_t chord = ((uint32_t)radius * SIN_TABLE[spanDegrees] + (1 << 13)) >> 14;
+
+    // Past a radius of 32767 the chord can need 17 bits
+    return chord > UINT16_MAX ? UINT16_MAX : (uint16_t)chord;
+}
@@ -0,0 +1,34 @@
+/**
+ * trig.h
+ *
+ * Contains integer sine/cosine backed by a compile-time table, so geometry on the scan data never touches
+ * soft-float libm
+ *
+ * Angles are in half degrees (the scan's finest angular step is 1 degree, and half of that is what a chord
+ * needs). Results are Q15: 32767 is 1.0. Table entries are round(32768 * sin), capped at 32767, so every
+ * result is within 1/32768 of the true value.
+ * 
+ * @date November 25, 2025
+ * @author Thiago Bedal
+ * @author Joseph Vesterby
+**/
+
+#ifndef TRIG_H_
+#define TRIG_H_
+
+#include <stdint.h>
+
+// Number of half-degree steps in a full turn
+#define TRIG_FULL_TURN 720
+
+// sin of halfDegrees / 2 degrees in Q15, any angle (negative and past a full turn wrap)
+int16_t trig_sinQ15(int32_t halfDegrees);
+
+// cos of halfDegrees / 2 degrees in Q15, any angle
+int16_t trig_cosQ15(int32_t halfDegrees);
+
+// Chord length 2 * radius * sin(angle / 2) for an angle of spanDegrees (0-180), rounded to the nearest unit.
+// Same unit as radius, error at most 0.5 + radius / 16384 (under 0.7 mm at 3 m). Saturates at UINT16_MAX
+uint16_t trig_chord(uint16_t radius, uint8_t spanDegrees);
+
+#endif /* TRIG_H_ */
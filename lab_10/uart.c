@@ -11,13 +11,51 @@
 /* <----------| INCLUDES |----------> */
 
 #include "uart.h"
+#include "dma.h"
 
 /* <----------| DEFINITIONS |----------> */
 
+// Ring buffer sizes. Must be powers of two so free-running indices can be masked
+#define UART_TX_BUFFER_SIZE 256
+#define UART_RX_BUFFER_SIZE 64
+
 // TODO: do we need these here?
 extern volatile char uart_data;
 extern volatile char flag;
 
+// Single-producer/single-consumer rings. main() owns the TX head and RX tail, the ISR owns the TX tail and RX head
+static volatile uint8_t txBuffer[UART_TX_BUFFER_SIZE];
+static volatile uint16_t txHead = 0;
+static volatile uint16_t txTail = 0;
+static volatile uint8_t rxBuffer[UART_RX_BUFFER_SIZE];
+static volatile uint16_t rxHead = 0;
+static volatile uint16_t rxTail = 0;
+
+static volatile uart_stats_t stats;
+
+// Buffers handed to uart_sendBufferAsync(). Slot 0 is the one draining, slot 1 is queued behind it
+typedef struct {
+    const uint8_t *data;
+    size_t length;
+    uart_txCallback_t callback;
+} uart_dmaJob_t;
+
+static volatile uart_dmaJob_t dmaJobs[2];
+static volatile uint8_t dmaJobCount = 0;
+static volatile size_t dmaJobSent = 0; // Bytes of slot 0 already handed to the controller
+
+// Programs the next chunk (up to DMA_MAX_TRANSFER bytes) of slot 0 and arms the channel
+static void uart_startDmaChunk(void);
+
+// Called from the ISR when the channel has gone idle: continues, completes, or promotes the next buffer
+static void uart_serviceDma(void);
+
+// Moves bytes from the TX ring into the hardware FIFO until either one runs out. Only call with TX interrupts masked or from the ISR
+static void uart_fillTxFifo(void);
+
+// Pauses the ISR's TX path, tops up the FIFO and re-arms the TX interrupt if bytes are still waiting
+static void uart_kickTx(void);
+
 /* <----------| IMPLEMENTATIONS |----------> */
 
 void uart_init(int baud) {
@@ -39,30 +77,39 @@ void uart_init(int baud) {
     UART1_CTL_R &= 0xFFFFFFFE;      // disable UART1 (page 918)
     UART1_IBRD_R |= ibrd;        // write integer portion of BRD to IBRD
     UART1_FBRD_R |= (int)(fbrd * 64 + 0.5);   // write fractional portion of BRD to FBRD
-    UART1_LCRH_R = 0b0110'0000;        // write serial communication parameters (page 916) * 8bit and no parity
+    UART1_LCRH_R = 0b0111'0000;        // write serial communication parameters (page 916) * 8bit, no parity, FIFOs enabled
+    UART1_IFLS_R = 0b0001'0000;        // RX interrupt at 1/2 full, TX interrupt at 1/8 full (page 917)
     UART1_CC_R   = 0x0;          // use system clock as clock source (page 939)
     UART1_CTL_R |= 0000'0001;        // enable UART1
+
+    // Route UART1 TX requests to the uDMA controller for uart_sendBufferAsync()
+    dma_init();
+    dma_configureChannel(DMA_CHANNEL_UART1_TX, 0);
+    UART1_DMACTL_R |= 0b10;            // enable TX DMA requests (page 936)
+
+    // Everything goes through the ring buffers, so the ISR has to be live before the first byte
+    uart_interruptInit();
 }
 
 void uart_sendChar(char data) {
-    uint32_t original_UART_DR = UART1_DR_R;
-
-    original_UART_DR &= 0xFFFFFF00;
-    original_UART_DR |= data;
+    // Ring full: make sure the ISR is draining it, then wait for room
+    while ((uint16_t)(txHead - txTail) >= UART_TX_BUFFER_SIZE) {
+        uart_kickTx();
+    }
 
-    UART1_DR_R = original_UART_DR;
+    txBuffer[txHead & (UART_TX_BUFFER_SIZE - 1)] = data;
+    txHead++;
 
-    while (UART1_FR_R & 0b0000'1000) {
-        // Wait
-    }
+    uart_kickTx();
 }
 
 char uart_getChar(void) {
-    while (UART1_FR_R & 0b0001'0000) {
-        // Wait
+    while (rxHead == rxTail) {
+        // Wait for the ISR to hand us a byte
     }
 
-    char recievedChar = (char)UART1_DR_R;
+    char recievedChar = (char)rxBuffer[rxTail & (UART_RX_BUFFER_SIZE - 1)];
+    rxTail++;
 
     return recievedChar;
 }
@@ -75,10 +122,49 @@ void uart_sendStr(const char *data) {
     }
 }
 
+bool uart_sendBufferAsync(const uint8_t *data, size_t length, uart_txCallback_t callback) {
+    if (length == 0 || dmaJobCount >= 2) {
+        return false;
+    }
+
+    // Let bytes already queued through uart_sendChar go out first so output stays in order
+    if (dmaJobCount == 0) {
+        while (txHead != txTail) {
+            uart_kickTx();
+        }
+    }
+
+    // Returns true if interrupts were already masked, in which case the caller keeps them that way
+    bool wasMasked = IntMasterDisable();
+
+    dmaJobs[dmaJobCount].data = data;
+    dmaJobs[dmaJobCount].length = length;
+    dmaJobs[dmaJobCount].callback = callback;
+    dmaJobCount++;
+
+    if (dmaJobCount == 1) {
+        dmaJobSent = 0;
+        uart_startDmaChunk();
+    }
+
+    if (!wasMasked) {
+        IntMasterEnable();
+    }
+
+    return true;
+}
+
+uint8_t uart_pendingBuffers(void) {
+    return dmaJobCount;
+}
+
+uart_stats_t uart_getStats(void) {
+    return stats;
+}
 
 void uart_interruptInit() {
-    // Enable interrupts for receiving bytes through UART1
-    UART1_IM_R |= 0b0001'0000; //enable interrupt on receive - page 924
+    // Enable interrupts for receiving bytes through UART1. TX interrupts are armed on demand by uart_kickTx()
+    UART1_IM_R |= 0b0101'0000; //enable interrupt on receive and receive timeout - page 924
 
     // Find the NVIC enable register and bit responsible for UART1 in table 2-9
     // Note: NVIC register descriptions are found in chapter 3.4
@@ -86,20 +172,119 @@ void uart_interruptInit() {
 
     // Find the vector number of UART1 in table 2-9 ! UART1 is 22 from vector number page 104
     IntRegister(INT_UART1, uart_interruptHandler); //give the microcontroller the address of our interrupt handler - page 104 22 is the vector number
+
+    IntMasterEnable();
 }
 
 void uart_interruptHandler() {
-    // STEP 1: Check the Masked Interrupt Status
-    if (!(UART1_MIS_R & 0b0001'0000)) {
+    uint32_t status = UART1_MIS_R;
+    stats.interrupts++;
+
+    // STEP 0: uDMA completion arrives on this vector with no UART status bit, so check the channel itself
+    //         The completion bit in UDMACHIS has to be cleared by hand or the vector stays pending
+    if (dmaJobCount && !dma_isChannelEnabled(DMA_CHANNEL_UART1_TX)) {
+        dma_clearInterrupt(DMA_CHANNEL_UART1_TX);
+        uart_serviceDma();
+    }
+
+    // STEP 1: Drain the RX FIFO on receive (1/2 full) or receive timeout (stragglers)
+    if (status & 0b0101'0000) {
+        UART1_ICR_R |= 0b0101'0000;
+
+        while (!(UART1_FR_R & 0b0001'0000)) {
+            char received = (char)UART1_DR_R;
+
+            if ((uint16_t)(rxHead - rxTail) < UART_RX_BUFFER_SIZE) {
+                rxBuffer[rxHead & (UART_RX_BUFFER_SIZE - 1)] = received;
+                rxHead++;
+                stats.rxBytes++;
+            }
+            else {
+                stats.rxOverflows++;
+            }
+
+            uart_data = received;
+            flag = 1;
+        }
+    }
+
+    // STEP 2: Refill the TX FIFO in bulk, and stop TX interrupts once the ring is empty
+    if ((status & 0b0010'0000) && (UART1_IM_R & 0b0010'0000)) {
+        UART1_ICR_R |= 0b0010'0000;
+
+        uart_fillTxFifo();
+
+        if (txHead == txTail) {
+            UART1_IM_R &= ~0b0010'0000;
+        }
+    }
+}
+
+static void uart_fillTxFifo(void) {
+    // The controller owns the FIFO until every queued buffer has drained
+    if (dmaJobCount) {
         return;
     }
 
-    // STEP 2: Copy the data
-    uart_data = uart_data = uart_getChar();
-    flag = 1;
+    while (txHead != txTail && !(UART1_FR_R & 0b0010'0000)) {
+        UART1_DR_R = txBuffer[txTail & (UART_TX_BUFFER_SIZE - 1)];
+        txTail++;
+        stats.txBytes++;
+    }
+}
+
+static void uart_kickTx(void) {
+    UART1_IM_R &= ~0b0010'0000;
 
-    // STEP 3: Clear the interrupt
-    UART1_ICR_R |= 0b0001'0000;
+    uart_fillTxFifo();
 
+    // FIFO is full if bytes are left over, so the 1/8 threshold crossing will wake the ISR.
+    // While DMA is busy, uart_serviceDma() kicks again once the last buffer completes
+    if (txHead != txTail && !dmaJobCount) {
+        UART1_IM_R |= 0b0010'0000;
+    }
+}
 
+static void uart_startDmaChunk(void) {
+    size_t remaining = dmaJobs[0].length - dmaJobSent;
+    uint16_t chunk = remaining > DMA_MAX_TRANSFER ? DMA_MAX_TRANSFER : (uint16_t)remaining;
+
+    dma_setTransfer(DMA_CHANNEL_UART1_TX, false, (volatile void *)(dmaJobs[0].data + dmaJobSent), &UART1_DR_R,
+                    UDMA_CHCTL_DSTINC_NONE | UDMA_CHCTL_DSTSIZE_8 | UDMA_CHCTL_SRCINC_8 | UDMA_CHCTL_SRCSIZE_8 |
+                    UDMA_CHCTL_ARBSIZE_4 | UDMA_CHCTL_XFERMODE_BASIC, chunk);
+    dmaJobSent += chunk;
+
+    dma_enableChannel(DMA_CHANNEL_UART1_TX);
+}
+
+static void uart_serviceDma(void) {
+    // Long buffers go out in DMA_MAX_TRANSFER pieces
+    if (dmaJobSent < dmaJobs[0].length) {
+        uart_startDmaChunk();
+        return;
+    }
+
+    const uint8_t *finishedData = dmaJobs[0].data;
+    size_t finishedLength = dmaJobs[0].length;
+    uart_txCallback_t finishedCallback = dmaJobs[0].callback;
+
+    stats.txBytes += finishedLength;
+
+    // Promote the queued buffer before the callback so the caller can immediately queue another
+    dmaJobs[0] = dmaJobs[1];
+    dmaJobCount--;
+    dmaJobSent = 0;
+
+    if (dmaJobCount) {
+        uart_startDmaChunk();
+    }
+
+    // Buffer belongs to the caller again from here on
+    if (finishedCallback) {
+        finishedCallback(finishedData, finishedLength);
+    }
+
+    if (!dmaJobCount) {
+        uart_kickTx();
+    }
 }
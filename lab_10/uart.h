@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <inc/tm4c123gh6pm.h>
 #include "driverlib/interrupt.h"
 #include "timer.h"
@@ -25,15 +26,40 @@ extern volatile  char flag;       // Your UART interupt can update this flag
                                   // to indicate that it has placed new data
                                   // in uart_data
 
+// Counters kept by the UART1 ISR. interrupts vs. tx/rxBytes gives bytes moved per ISR
+typedef struct {
+    uint32_t interrupts;
+    uint32_t txBytes;
+    uint32_t rxBytes;
+    uint32_t rxOverflows;
+} uart_stats_t;
 
+// Called from the UART1 ISR once uDMA has copied a uart_sendBufferAsync() buffer into the TX FIFO, so the buffer
+// may be reused. Up to 16 of its bytes can still be shifting out of the UART at that point
+typedef void (*uart_txCallback_t)(const uint8_t *data, size_t length);
+
+// Sets up UART1 with FIFOs and interrupt-driven TX/RX ring buffers
 void uart_init(int baud);
 
+// Queues a byte for transmission. Only blocks if the TX ring is full
 void uart_sendChar(char data);
 
+// Returns the next received byte, waiting until one arrives
 char uart_getChar(void);
 
 void uart_sendStr(const char *data);
 
+// Hands a buffer to uDMA and returns immediately. Up to two buffers can be queued (double-buffering);
+// returns false if both slots are taken. The buffer must not be touched until callback runs.
+// Bytes sent with uart_sendChar while DMA is busy go out after the queued buffers
+bool uart_sendBufferAsync(const uint8_t *data, size_t length, uart_txCallback_t callback);
+
+// Returns how many uart_sendBufferAsync() buffers are still queued or draining (0-2)
+uint8_t uart_pendingBuffers(void);
+
+// Returns a snapshot of the ISR counters
+uart_stats_t uart_getStats(void);
+
 void uart_interruptInit();
 
 void uart_interruptHandler();